@@ -0,0 +1,754 @@
+// Abstraction overhead of the adapters: every case is measured as an adapter chain, as the equivalent hand-written
+// loop and, where the standard library has ranges, as the equivalent std::views pipeline, over a std::vector, a
+// std::list and a std::unordered_map of the same elements. The results are machine readable with
+// --benchmark_format=json (or --benchmark_out=results.json), and a case whose "adapter" run is slower than its "loop"
+// run by more than the noise is a regression.
+
+#include "iterator_adapters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <list>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+
+namespace
+{
+using Element = std::int64_t;
+
+// the mapped value of std::unordered_map elements, the elements of the other containers
+Element value(Element x) { return x; }
+
+Element value(std::pair<Element const, Element> const& x) { return x.second; }
+
+template <typename ContainerT>
+ContainerT make(size_t n)
+{
+    ContainerT container;
+    for (size_t i = 0; i < n; ++i) {
+        // a non-constant pattern, so that neither the filters nor the searches can be folded away
+        auto const x = static_cast<Element>((i * 7919) % 1009);
+        if constexpr (std::is_same_v<ContainerT, std::unordered_map<Element, Element>>) {
+            container.emplace(static_cast<Element>(i), x);
+        }
+        else {
+            container.push_back(x);
+        }
+    }
+    return container;
+}
+
+constexpr auto square = [](auto const& x) { return value(x) * value(x); };
+constexpr auto odd = [](auto const& x) { return (value(x) & 1) != 0; };
+constexpr auto add = [](Element acc, auto const& x) { return acc + value(x); };
+
+// the element that no search finds, so that every search scans the whole container
+constexpr Element missing = -1;
+
+#if defined(__cpp_lib_ranges)
+constexpr auto values = std::views::transform([](auto const& x) { return value(x); });
+#endif
+
+/// composables, each reduced to a sum so that the whole chain is evaluated
+
+struct Chain {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).chain(iter(&c)).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        for (auto const& x : c) {
+            sum += value(x);
+        }
+        for (auto const& x : c) {
+            sum += value(x);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        std::array<C const*, 2> const both = {&c, &c};
+        Element sum = 0;
+        for (Element x : both | std::views::transform([](C const* p) { return *p | values; }) | std::views::join) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Enumerate {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).enumerate().fold(Element{0}, [](Element acc, auto const& p) {
+            return acc + static_cast<Element>(p.first) * value(p.second);
+        });
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        size_t i = 0;
+        for (auto const& x : c) {
+            sum += static_cast<Element>(i++) * value(x);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges_zip)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (auto const [i, x] : std::views::zip(std::views::iota(size_t{0}), c | values)) {
+            sum += static_cast<Element>(i) * x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Filter {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).filter(odd).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        for (auto const& x : c) {
+            if (odd(x)) {
+                sum += value(x);
+            }
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (Element x : c | std::views::filter(odd) | values) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Map {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).map(square).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        for (auto const& x : c) {
+            sum += square(x);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (Element x : c | std::views::transform(square)) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Reverse {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        Element i = 0;
+        return iter(&c).reverse().fold(Element{0}, [&i](Element acc, auto const& x) {
+            return acc + (++i) * value(x);
+        });
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        Element i = 0;
+        for (auto it = c.rbegin(); it != c.rend(); ++it) {
+            sum += (++i) * value(*it);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        Element i = 0;
+        for (Element x : c | std::views::reverse | values) {
+            sum += (++i) * x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Skip {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).skip(c.size() / 2).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        auto it = c.begin();
+        std::advance(it, static_cast<std::ptrdiff_t>(c.size() / 2));
+        for (; it != c.end(); ++it) {
+            sum += value(*it);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (Element x : c | std::views::drop(c.size() / 2) | values) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct StepBy {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).step_by(3).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        size_t i = 0;
+        for (auto const& x : c) {
+            if ((i++ % 3) == 0) {
+                sum += value(x);
+            }
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges) && defined(__cpp_lib_ranges_stride)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (Element x : c | std::views::stride(3) | values) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Take {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).take(c.size() / 2).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        size_t n = c.size() / 2;
+        for (auto it = c.begin(); n != 0; ++it, --n) {
+            sum += value(*it);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (Element x : c | std::views::take(c.size() / 2) | values) {
+            sum += x;
+        }
+        return sum;
+    }
+#endif
+};
+
+struct Zip {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).zip(iter(&c)).fold(Element{0}, [](Element acc, auto const& p) {
+            return acc + value(p.first) * value(p.second);
+        });
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element sum = 0;
+        for (auto lhs = c.begin(), rhs = c.begin(); lhs != c.end(); ++lhs, ++rhs) {
+            sum += value(*lhs) * value(*rhs);
+        }
+        return sum;
+    }
+
+#if defined(__cpp_lib_ranges_zip)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        for (auto const [lhs, rhs] : std::views::zip(c | values, c | values)) {
+            sum += lhs * rhs;
+        }
+        return sum;
+    }
+#endif
+};
+
+/// terminating methods
+
+struct All {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).all([](auto const& x) { return value(x) != missing; });
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        for (auto const& x : c) {
+            if (value(x) == missing) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return std::ranges::all_of(c | values, [](Element x) { return x != missing; });
+    }
+#endif
+};
+
+struct Any {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).any([](auto const& x) { return value(x) == missing; });
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        for (auto const& x : c) {
+            if (value(x) == missing) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return std::ranges::any_of(c | values, [](Element x) { return x == missing; });
+    }
+#endif
+};
+
+struct Collect {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return static_cast<Element>(iter(&c).map(square).template collect<std::vector<Element>>().size());
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        std::vector<Element> out;
+        out.reserve(c.size());
+        for (auto const& x : c) {
+            out.push_back(square(x));
+        }
+        return static_cast<Element>(out.size());
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        auto squares = c | std::views::transform(square);
+        return static_cast<Element>(std::vector<Element>(squares.begin(), squares.end()).size());
+    }
+#endif
+};
+
+struct Count {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return static_cast<Element>(iter(&c).filter(odd).count());
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element n = 0;
+        for (auto const& x : c) {
+            n += odd(x);
+        }
+        return n;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return static_cast<Element>(std::ranges::distance(c | std::views::filter(odd)));
+    }
+#endif
+};
+
+struct CountIf {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return static_cast<Element>(iter(&c).count_if(odd));
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return Count::loop(c);
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return static_cast<Element>(std::ranges::count_if(c, odd));
+    }
+#endif
+};
+
+struct Find {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).find([](auto const& x) { return value(x) == missing; }).has_value();
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return Any::loop(c);
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        auto const range = c | values;
+        return std::ranges::find(range, missing) != range.end();
+    }
+#endif
+};
+
+struct Fold {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).fold(Element{0}, add);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return std::accumulate(c.begin(), c.end(), Element{0}, add);
+    }
+};
+
+struct ForEach {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        Element sum = 0;
+        iter(&c).for_each([&sum](auto const& x) { sum += value(x); });
+        return sum;
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return Fold::loop(c);
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        Element sum = 0;
+        std::ranges::for_each(c, [&sum](auto const& x) { sum += value(x); });
+        return sum;
+    }
+#endif
+};
+
+struct Last {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return value(*iter(&c).last());
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        std::optional<Element> last;
+        for (auto const& x : c) {
+            last = value(x);
+        }
+        return *last;
+    }
+};
+
+struct Max {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return *iter(&c).map([](auto const& x) { return value(x); }).max();
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        Element best = value(*c.begin());
+        for (auto const& x : c) {
+            best = std::max(best, value(x));
+        }
+        return best;
+    }
+
+#if defined(__cpp_lib_ranges)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return std::ranges::max(c | values);
+    }
+#endif
+};
+
+struct Nth {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return value(*iter(&c).nth(c.size() - 1));
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return value(*std::next(c.begin(), static_cast<std::ptrdiff_t>(c.size() - 1)));
+    }
+};
+
+struct Partition {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        auto const halves =
+            iter(&c).map([](auto const& x) { return value(x); }).template partition<std::vector<Element>>(odd);
+        return static_cast<Element>(halves.first.size() - halves.second.size());
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        std::pair<std::vector<Element>, std::vector<Element>> halves;
+        for (auto const& x : c) {
+            (odd(x) ? halves.first : halves.second).push_back(value(x));
+        }
+        return static_cast<Element>(halves.first.size() - halves.second.size());
+    }
+};
+
+struct Position {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).position([](auto const& x) { return value(x) == missing; }).value_or(0);
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        size_t i = 0;
+        for (auto const& x : c) {
+            if (value(x) == missing) {
+                return static_cast<Element>(i);
+            }
+            ++i;
+        }
+        return 0;
+    }
+};
+
+struct Sum {
+    template <typename C>
+    static Element adapter(C const& c)
+    {
+        return iter(&c).map([](auto const& x) { return value(x); }).sum();
+    }
+
+    template <typename C>
+    static Element loop(C const& c)
+    {
+        return Fold::loop(c);
+    }
+
+#if defined(__cpp_lib_ranges) && defined(__cpp_lib_ranges_fold)
+    template <typename C>
+    static Element views(C const& c)
+    {
+        return std::ranges::fold_left(c | values, Element{0}, std::plus<>{});
+    }
+#endif
+};
+
+template <typename CaseT, typename C, typename = void>
+constexpr bool HasViews = false;
+
+template <typename CaseT, typename C>
+constexpr bool HasViews<CaseT, C, std::void_t<decltype(CaseT::views(std::declval<C const&>()))>> = true;
+
+template <typename CaseT, typename C, Element (*Run)(C const&)>
+void run(benchmark::State& state)
+{
+    C const container = make<C>(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Run(container));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+template <typename CaseT, typename C>
+void add_case(std::string const& name, std::string const& source)
+{
+    auto const register_impl = [&](char const* impl, void (*fn)(benchmark::State&)) {
+        benchmark::RegisterBenchmark((name + "/" + source + "/" + impl).c_str(), fn)
+            ->RangeMultiplier(16)
+            ->Range(1 << 8, 1 << 16);
+    };
+    register_impl("adapter", &run<CaseT, C, &CaseT::template adapter<C>>);
+    register_impl("loop", &run<CaseT, C, &CaseT::template loop<C>>);
+    if constexpr (HasViews<CaseT, C>) {
+        register_impl("views", &run<CaseT, C, &CaseT::template views<C>>);
+    }
+}
+
+// std::unordered_map only has forward iterators
+template <typename CaseT, bool ForwardSources = true>
+void add_cases(std::string const& name)
+{
+    add_case<CaseT, std::vector<Element>>(name, "vector");
+    add_case<CaseT, std::list<Element>>(name, "list");
+    if constexpr (ForwardSources) {
+        add_case<CaseT, std::unordered_map<Element, Element>>(name, "unordered_map");
+    }
+}
+
+void register_all()
+{
+    add_cases<Chain>("Chain");
+    add_cases<Enumerate>("Enumerate");
+    add_cases<Filter>("Filter");
+    add_cases<Map>("Map");
+    add_cases<Reverse, false>("Reverse");
+    add_cases<Skip>("Skip");
+    add_cases<StepBy>("StepBy");
+    add_cases<Take>("Take");
+    add_cases<Zip>("Zip");
+
+    add_cases<All>("all");
+    add_cases<Any>("any");
+    add_cases<Collect>("collect");
+    add_cases<Count>("count");
+    add_cases<CountIf>("count_if");
+    add_cases<Find>("find");
+    add_cases<Fold>("fold");
+    add_cases<ForEach>("for_each");
+    add_cases<Last>("last");
+    add_cases<Max>("max");
+    add_cases<Nth>("nth");
+    add_cases<Partition>("partition");
+    add_cases<Position>("position");
+    add_cases<Sum>("sum");
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    register_all();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
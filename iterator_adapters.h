@@ -1,42 +1,137 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if (__cplusplus >= 202002L) && __has_include(<span>)
+#include <span>
+#endif
+
+#if (__cplusplus >= 202002L) && __has_include(<ranges>)
+#include <ranges>
+#endif
+
+#if (__cplusplus >= 202002L) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
 #define MOVE_ONLY(TYPE)                    \
     TYPE(TYPE const&) = delete;            \
     TYPE& operator=(TYPE const&) = delete; \
     TYPE(TYPE&&) = default;                \
     TYPE& operator=(TYPE&&) = default
 
-#define ALL_FRIEND                    \
-    template <typename X, typename Y> \
-    friend class AdapterBase;         \
-    template <typename X>             \
-    friend class Iterator;            \
-    template <typename X, typename Y> \
-    friend class Chain;               \
-    template <typename X>             \
-    friend class Enumerate;           \
-    template <typename X, typename Y> \
-    friend class Filter;              \
-    template <typename X, typename Y> \
-    friend class Map;                 \
-    template <typename X>             \
-    friend class Reverse;             \
-    template <typename X>             \
-    friend class Skip;                \
-    template <typename X>             \
-    friend class StepBy;              \
-    template <typename X>             \
-    friend class Take;                \
-    template <typename X, typename Y> \
-    friend class Zip;
+#if defined(__GNUC__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (!defined(__AVX2__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define ALL_FRIEND                                           \
+    template <typename X, typename Y>                        \
+    friend class AdapterBase;                                \
+    template <typename X>                                    \
+    friend class Iterator;                                   \
+    template <typename X, typename Y>                        \
+    friend class KMerge;                                     \
+    template <typename X, typename Y>                        \
+    friend class Chain;                                      \
+    template <typename X, typename... Y>                     \
+    friend class ChainAll;                                   \
+    template <typename X, bool B>                            \
+    friend class Chunks;                                     \
+    template <typename X>                                    \
+    friend class Dedup;                                      \
+    template <typename X>                                    \
+    friend class Enumerate;                                  \
+    template <typename X, typename Y>                        \
+    friend class Filter;                                     \
+    template <typename X>                                    \
+    friend class Flatten;                                    \
+    template <typename X>                                    \
+    friend class IndexedRangeIterator;                       \
+    template <typename X, typename Y>                        \
+    friend class Inspect;                                    \
+    template <typename X, size_t M>                          \
+    friend class Lookahead;                                  \
+    template <typename X, typename Y>                        \
+    friend class Map;                                        \
+    template <typename X, typename Y>                        \
+    friend class MapCached;                                  \
+    template <typename X, typename Y>                        \
+    friend class MapWhile;                                   \
+    template <typename X, typename Y, typename Z, MergeOp O> \
+    friend class Merge;                                      \
+    template <typename X>                                    \
+    friend class ParBridge;                                  \
+    template <typename X>                                    \
+    friend class PipelineStage;                              \
+    template <typename X, typename Y>                        \
+    friend class Profile;                                    \
+    template <typename X>                                    \
+    friend class RangeIterator;                              \
+    template <typename X>                                    \
+    friend class RangeView;                                  \
+    template <typename X>                                    \
+    friend class Reverse;                                    \
+    template <typename X>                                    \
+    friend class Skip;                                       \
+    template <typename X, typename Y>                        \
+    friend class SkipWhile;                                  \
+    template <typename X, typename Y>                        \
+    friend class Sorted;                                     \
+    template <typename X>                                    \
+    friend class SourceBase;                                 \
+    template <typename X>                                    \
+    friend class StepBy;                                     \
+    template <typename X>                                    \
+    friend class Take;                                       \
+    template <typename X, typename Y>                        \
+    friend class TakeWhile;                                  \
+    template <typename X, typename Y>                        \
+    friend class Unique;                                     \
+    template <typename X, typename Y>                        \
+    friend class WithExecutor;                               \
+    template <typename X>                                    \
+    friend class Windows;                                    \
+    template <typename X, typename Y>                        \
+    friend class Zip;                                        \
+    template <typename X, typename... Y>                     \
+    friend class ZipAll;
 
 namespace detail
 {
@@ -55,754 +150,7141 @@ constexpr bool Iterable<
         decltype(std::declval<T>().cbegin()),
         decltype(std::declval<T>().cend())>> = true;
 
-template <typename IterT>
-constexpr bool IsBidirectionalV =
-    std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<IterT>::iterator_category>;
-
-template <typename T>
-struct Emplacer final {
-    template <typename... Args>
-    static void emplace(T& container, Args&&... args)
-    {
-        container.emplace(std::forward<Args>(args)...);
-    }
-};
-
-template <typename T>
-struct Emplacer<std::vector<T>> final {
-    template <typename U>
-    static void emplace(std::vector<T>& vec, U&& value)
-    {
-        vec.emplace_back(std::forward<U>(value));
-    }
-};
-
-template <typename T>
-struct Emplacer<std::list<T>> final {
-    template <typename U>
-    static void emplace(std::list<T>& list, U&& value)
-    {
-        list.emplace_back(std::forward<U>(value));
-    }
-};
+template <typename T, typename = void>
+constexpr bool Reservable = false;
 
 template <typename T>
-class [[nodiscard]] Iterator;
+constexpr bool Reservable<T, std::void_t<decltype(std::declval<T&>().reserve(size_t{}))>> = true;
 
-template <typename T, typename U>
-class [[nodiscard]] Chain;
+template <typename T, typename = void>
+constexpr bool Mergeable = false;
 
 template <typename T>
-class [[nodiscard]] Enumerate;
+constexpr bool Mergeable<T, std::void_t<decltype(std::declval<T&>().merge(std::declval<T&>()))>> = true;
 
-template <typename T, typename FnT>
-class [[nodiscard]] Filter;
+template <typename IterT>
+constexpr bool IsBidirectionalV =
+    std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<IterT>::iterator_category>;
 
-template <typename T, typename FnT>
-class [[nodiscard]] Map;
+template <typename IterT>
+constexpr bool IsRandomAccessV =
+    std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<IterT>::iterator_category>;
 
-template <typename T>
-class [[nodiscard]] Reverse;
+/// iterators of containers with a data() pointer (std::vector, std::array, std::string, ...) and raw pointers
+template <typename T, typename IterT, typename = void>
+constexpr bool IsContiguousV = std::is_pointer_v<IterT>;
 
-template <typename T>
-class [[nodiscard]] Skip;
+template <typename T, typename IterT>
+constexpr bool IsContiguousV<T, IterT, std::enable_if_t<std::is_pointer_v<decltype(std::declval<T&>().data())>>> =
+    std::is_pointer_v<IterT> || std::is_same_v<IterT, typename T::iterator> ||
+    std::is_same_v<IterT, typename T::const_iterator>;
 
+#if defined(__cpp_lib_span)
 template <typename T>
-class [[nodiscard]] StepBy;
-
+using Span = std::span<T>;
+#else
+/// stand-in for std::span before C++20
 template <typename T>
-class [[nodiscard]] Take;
-
-template <typename T, typename U>
-class [[nodiscard]] Zip;
-
-template <typename T, typename IterT>
-class [[nodiscard]] IterPair final {
+class Span final {
 public:
-    MOVE_ONLY(IterPair);
-
-    ALL_FRIEND;
-
-    using value_type = decltype(*std::declval<IterT>());
-    using std_iterator = IterT;
-    using mut_or_const_iterator = IterT;
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
 
-    static_assert(std::is_reference_v<value_type>);
+    constexpr Span() = default;
 
-    explicit IterPair(T const& t)
-    : m_iter(t.begin())
-    , m_end(t.end())
+    constexpr Span(T* data, size_t size)
+    : m_data(data)
+    , m_size(size)
     {
     }
 
-    explicit IterPair(T& t)
-    : m_iter(t.begin())
-    , m_end(t.end())
-    {
-    }
+    constexpr T* data() const { return m_data; }
 
-    explicit IterPair(T&& t) = delete;
+    constexpr size_t size() const { return m_size; }
 
-    value_type operator*() { return next(); }
+    [[nodiscard]] constexpr bool empty() const { return m_size == 0; }
 
-private:
-    bool empty() const { return m_iter == m_end; }
+    constexpr T* begin() const { return m_data; }
 
-    size_t distance() const { return static_cast<size_t>(std::distance(m_iter, m_end)); }
+    constexpr T* end() const { return m_data + m_size; }
 
-    value_type get() { return *m_iter; }
+    constexpr T& front() const { return m_data[0]; }
 
-    value_type get_back()
-    {
-        if constexpr (IsBidirectionalV<IterT>) {
-            auto copy = m_end;
-            return *(--copy);
-        }
-        else {
-            return *m_end;
-        }
-    }
+    constexpr T& back() const { return m_data[m_size - 1]; }
 
-    value_type next()
-    {
-        value_type item = *m_iter;
-        ++m_iter;
-        return item;
-    }
+    constexpr T& operator[](size_t i) const { return m_data[i]; }
 
-    value_type next_back()
-    {
-        if constexpr (IsBidirectionalV<IterT>) {
-            --m_end;
-        }
-        return *m_end;
-    }
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+#endif
 
-    void stop_iteration() { m_iter = m_end; }
+using SizeHint = std::pair<size_t /* lower */, std::optional<size_t> /* upper */>;
 
-    mut_or_const_iterator m_iter;
-    mut_or_const_iterator m_end;
+/// lvalue references are kept as references, rvalue references are moved into the optional
+template <typename T>
+using Fallible = std::conditional_t<
+    std::is_lvalue_reference_v<T>,
+    std::optional<std::reference_wrapper<std::remove_reference_t<T>>>,
+    std::optional<std::remove_reference_t<T>>>;
+
+/// integers are accumulated unsigned and at least as wide as int, so that overflow wraps around like it does for
+/// the result type instead of being undefined
+template <typename T, typename = void>
+struct Accumulator final {
+    using type = T;
 };
 
-class Adapter {
-protected:
-    ~Adapter() = default;
+template <typename T>
+struct Accumulator<T, std::enable_if_t<std::is_integral_v<T> && (!std::is_same_v<T, bool>)>> final {
+    using type = std::common_type_t<std::make_unsigned_t<T>, unsigned>;
 };
 
-template <typename T, typename AdapterT>
-class [[nodiscard]] AdapterBase : public Adapter {
-public:
-    MOVE_ONLY(AdapterBase);
+template <typename T>
+using AccumulatorT = typename Accumulator<T>::type;
 
-    explicit AdapterBase(T&& t)
-    : m_iter(std::move(t))
-    {
+/// independent accumulators, enough to fill two 256-bit registers and hide the latency of the operation
+template <typename T>
+constexpr size_t LanesV = std::clamp<size_t>(64 / sizeof(T), 4, 32);
+
+template <size_t Lanes, typename AccT, typename StepT>
+ALWAYS_INLINE void unrolled_fold(size_t n, AccT (&lanes)[Lanes], StepT& step)
+{
+    // local lanes cannot alias the elements, which keeps them in registers
+    AccT acc[Lanes];
+    std::copy(std::begin(lanes), std::end(lanes), std::begin(acc));
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j) {
+            step(acc[j], i + j);
+        }
     }
+    for (; i < n; ++i) {
+        step(acc[i % Lanes], i);
+    }
+    std::copy(std::begin(acc), std::end(acc), std::begin(lanes));
+}
 
-    /// iterators
-    AdapterT begin() { return cbegin(); }
+#if defined(TARGET_AVX2)
+template <size_t Lanes, typename AccT, typename StepT>
+TARGET_AVX2 void unrolled_fold_avx2(size_t n, AccT (&acc)[Lanes], StepT& step)
+{
+    unrolled_fold(n, acc, step);
+}
 
-    AdapterT begin() const { return cbegin(); }
+inline bool has_avx2()
+{
+    static bool const supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return supported;
+}
+#endif
 
-    AdapterT cbegin() const
-    {
-        auto& self = const_cast<AdapterT&>(downcast());
-        AdapterT clone = std::move(self);
-        self.stop_iteration();
-        return clone;
-    }
+/// std::is_constant_evaluated() before C++20, where the compiler provides it; run-time only paths are skipped in
+/// constant expressions
+constexpr bool is_constant_evaluated() noexcept
+{
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#elif defined(__GNUC__)
+    return __builtin_is_constant_evaluated();
+#else
+    return false;
+#endif
+}
 
-    int end() { return 0; }
+/// step(acc, i) folds element i into one of the lanes, which are combined at the end. The lanes are laid out for
+/// the vectorizer: SSE2 or NEON by default, AVX2 when the CPU supports it.
+template <typename AccT, typename StepT, typename CombineT>
+AccT lanes_fold(size_t n, AccT init, StepT step, CombineT const& combine)
+{
+    AccT acc[LanesV<AccT>];
+    std::fill(std::begin(acc), std::end(acc), init);
+#if defined(TARGET_AVX2)
+    if (has_avx2()) {
+        unrolled_fold_avx2(n, acc, step);
+    }
+    else {
+        unrolled_fold(n, acc, step);
+    }
+#else
+    unrolled_fold(n, acc, step);
+#endif
+    AccT result = acc[0];
+    for (size_t j = 1; j < LanesV<AccT>; ++j) {
+        result = combine(result, acc[j]);
+    }
+    return result;
+}
 
-    int end() const { return 0; }
+template <typename T>
+constexpr bool IsOptionalV = false;
 
-    int cend() const { return 0; }
+template <typename T>
+constexpr bool IsOptionalV<std::optional<T>> = true;
 
-    /// accessors
-    AdapterBase& operator++() { return *this; }
+template <typename T>
+constexpr bool IsStdArrayV = false;
 
-    bool operator!=(int) const { return !downcast().empty(); }
+template <typename T, size_t N>
+constexpr bool IsStdArrayV<std::array<T, N>> = true;
 
-    /// adapters
-    template <typename FnT>
-    [[nodiscard]] bool all(FnT const& fn)
-    {
-        return any_or_all(fn, false);
-    }
+template <typename T, template <typename...> class C>
+constexpr bool IsSpecializationV = false;
 
-    template <typename FnT>
-    [[nodiscard]] bool any(FnT const& fn)
-    {
-        return any_or_all(fn, true);
-    }
+template <template <typename...> class C, typename... Args>
+constexpr bool IsSpecializationV<C<Args...>, C> = true;
 
+/// second(first(item)), the function of two adjacent maps fused into one
+template <typename FirstT, typename SecondT>
+struct Composed final {
     template <typename U>
-    Chain<AdapterT, U> chain(U&& u)
+    constexpr decltype(auto) operator()(U&& item)
     {
-        return Chain<AdapterT, U>(std::move(downcast()), std::forward<U>(u));
+        return second(first(std::forward<U>(item)));
     }
 
-    template <typename ContainerT>
-    [[nodiscard]] ContainerT collect()
-    {
-        ContainerT container{};
-        for (auto& self = downcast(); !self.empty();) {
-            Emplacer<ContainerT>::emplace(container, self.next());
-        }
-        return container;
-    }
+    FirstT first;
+    SecondT second;
+};
 
-    [[nodiscard]] size_t count()
+/// first(item) && second(item), the predicate of two adjacent filters fused into one. Both see the same lvalue that
+/// an unfused filter passes, and the call is constrained on both so that Filter still checks the predicates.
+template <typename FirstT, typename SecondT>
+struct Conjoined final {
+    template <typename U>
+    constexpr auto operator()(U&& item) const
+        -> decltype(std::declval<FirstT const&>()(item) && std::declval<SecondT const&>()(item))
     {
-        size_t i = 0;
-        for (auto& self = downcast(); !self.empty(); self.next()) {
-            ++i;
-        }
-        return i;
+        return first(item) && second(item);
     }
 
-    Enumerate<AdapterT> enumerate() { return Enumerate<AdapterT>(std::move(downcast())); }
-
-    template <typename FnT>
-    Filter<AdapterT, FnT> filter(FnT&& fn)
-    {
-        return Filter<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
-    }
+    FirstT first;
+    SecondT second;
+};
 
-    template <typename FnT>
-    [[nodiscard]] auto find(FnT const& fn) /* -> std::optional<value_type> */
+template <typename T>
+struct Emplacer final {
+    template <typename... Args>
+    static void emplace(T& container, Args&&... args)
     {
-        advance_while(fn, false);
-        return fallible_deref();
+        container.emplace(std::forward<Args>(args)...);
     }
 
-    template <typename InitT, typename FnT>
-    [[nodiscard]] InitT fold(InitT const& init, FnT const& fn)
+    static void reserve(T& container, size_t n)
     {
-        InitT result = init;
-        for (auto& self = downcast(); !self.empty();) {
-            result = fn(result, self.next());
+        if constexpr (Reservable<T>) {
+            container.reserve(n);
         }
-        return result;
     }
 
-    template <typename FnT>
-    void for_each(FnT const& fn)
+    static void append(T& container, T&& other)
     {
-        for (auto& self = downcast(); !self.empty();) {
-            fn(self.next());
+        if constexpr (Mergeable<T>) {
+            container.merge(other);
+        }
+        else {
+            for (auto& item : other) {
+                emplace(container, std::move(item));
+            }
         }
     }
 
-    [[nodiscard]] auto last() /* -> std::optional<value_type> */
+    template <typename U>
+    static void append(T& container, Span<U> span)
     {
-        for (auto& self = downcast();;) {
-            auto result = fallible_deref();
-            if (!self.empty()) {
-                self.next();
-            }
-            if (self.empty()) {
-                return result;
-            }
+        for (auto& item : span) {
+            emplace(container, item);
         }
     }
+};
 
-    template <typename FnT>
-    Map<AdapterT, FnT> map(FnT&& fn)
+template <typename T, typename AllocT>
+struct Emplacer<std::vector<T, AllocT>> final {
+    template <typename U>
+    static void emplace(std::vector<T, AllocT>& vec, U&& value)
     {
-        return Map<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+        vec.emplace_back(std::forward<U>(value));
     }
 
-    [[nodiscard]] auto nth(size_t n) /* -> std::optional<value_type> */
+    static void reserve(std::vector<T, AllocT>& vec, size_t n) { vec.reserve(n); }
+
+    static void append(std::vector<T, AllocT>& vec, std::vector<T, AllocT>&& other)
     {
-        advance_by(n);
-        return fallible_deref();
+        vec.insert(vec.end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
     }
 
-    template <typename RetT, typename FnT>
-    [[nodiscard]] std::pair<RetT /* trues */, RetT /* falses */> partition(FnT const& fn)
+    template <typename U>
+    static void append(std::vector<T, AllocT>& vec, Span<U> span)
     {
-        std::pair<RetT, RetT> pair;
-        for (auto& self = downcast(); !self.empty();) {
-            auto& item = self.next();
-            if (fn(item)) {
-                Emplacer<RetT>::emplace(pair.first, item);
-            }
-            else {
-                Emplacer<RetT>::emplace(pair.second, item);
-            }
-        }
-        return pair;
+        vec.insert(vec.end(), span.begin(), span.end());
     }
+};
 
-    template <typename FnT>
-    [[nodiscard]] std::optional<size_t> position(FnT const& fn)
+template <typename T, typename AllocT>
+struct Emplacer<std::list<T, AllocT>> final {
+    template <typename U>
+    static void emplace(std::list<T, AllocT>& list, U&& value)
     {
-        size_t num_steps = advance_while(fn, false);
-        return (downcast().empty()) ? std::nullopt : std::optional<size_t>(num_steps);
+        list.emplace_back(std::forward<U>(value));
     }
 
-    Reverse<AdapterT> reverse() { return Reverse<AdapterT>(std::move(downcast())); }
-
-    Skip<AdapterT> skip(size_t n) { return Skip<AdapterT>(std::move(downcast()), n); }
-
-    StepBy<AdapterT> step_by(size_t step) { return StepBy<AdapterT>(std::move(downcast()), step); }
+    static void reserve(std::list<T, AllocT>&, size_t) {}
 
-    Take<AdapterT> take(size_t n) { return Take<AdapterT>(std::move(downcast()), n); }
+    static void append(std::list<T, AllocT>& list, std::list<T, AllocT>&& other) { list.splice(list.end(), other); }
 
     template <typename U>
-    Zip<AdapterT, U> zip(U&& u)
+    static void append(std::list<T, AllocT>& list, Span<U> span)
     {
-        return Zip<AdapterT, U>(std::move(downcast()), std::forward<U>(u));
+        list.insert(list.end(), span.begin(), span.end());
     }
+};
 
-protected:
-    using std_iterator = typename T::std_iterator;
-
-    ~AdapterBase() = default;
-
-    /* virtual */ typename T::value_type get() { return this->m_iter.get(); }
+/// keeps the first k items in the order of compare, in a heap whose front is the last of them; std::sort_heap() puts
+/// them in order
+template <typename VectorT, typename CompareT, typename U>
+void push_bounded(VectorT& heap, size_t k, CompareT const& compare, U&& item)
+{
+    if (heap.size() < k) {
+        heap.emplace_back(std::forward<U>(item));
+        std::push_heap(heap.begin(), heap.end(), compare);
+    }
+    else if ((k != 0) && compare(item, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), compare);
+        heap.back() = std::forward<U>(item);
+        std::push_heap(heap.begin(), heap.end(), compare);
+    }
+}
 
-    /* virtual */ typename T::value_type get_back() { return this->m_iter.get_back(); }
+/// the allocator of T elements for an allocator of any type, memory resources are wrapped in a polymorphic_allocator
+template <typename AllocT, typename T, typename = void>
+struct AllocatorFor final {
+    using type = typename std::allocator_traits<AllocT>::template rebind_alloc<T>;
+};
 
-    /* virtual */ typename T::value_type next() { return this->m_iter.next(); }
+template <typename AllocT, typename T>
+struct AllocatorFor<AllocT, T, std::enable_if_t<std::is_convertible_v<AllocT, std::pmr::memory_resource*>>> final {
+    using type = std::pmr::polymorphic_allocator<T>;
+};
 
-    /* virtual */ typename T::value_type next_back() { return this->m_iter.next_back(); }
+template <typename AllocT, typename T>
+using AllocatorForT = typename AllocatorFor<AllocT, T>::type;
 
-    /* virtual */ bool empty() const { return m_iter.empty(); }
+/// the tables of group_by(), counts_by() and unique() when none is given
+template <typename T, typename DefaultT>
+using OrDefaultT = std::conditional_t<std::is_void_v<T>, DefaultT, T>;
 
-    /* virtual */ void stop_iteration() { m_iter.stop_iteration(); }
+/// the most keys these tables are reserved for ahead, the number of elements is only an upper bound of the keys
+constexpr size_t MaxReservedKeys = size_t{1} << 16;
 
-    /* virtual */ size_t distance() const { return m_iter.distance(); }
+/// the key fn computes for an element of type T
+template <typename FnT, typename T>
+using KeyOfT = std::decay_t<std::invoke_result_t<FnT const&, std::decay_t<T> const&>>;
 
-    size_t advance_by(size_t n)
-    {
-        size_t num_steps = 0;
-        auto& self = downcast();
-        while ((!self.empty()) && (num_steps < n)) {
-            self.next();
-            ++num_steps;
+/// moves the entries of rhs into lhs, combine merges the value of a key found in both into the one in lhs
+template <typename MapT, typename CombineT>
+void merge_tables(MapT& lhs, MapT&& rhs, CombineT const& combine)
+{
+    for (auto& entry : rhs) {
+        auto const [it, inserted] = lhs.try_emplace(entry.first, std::move(entry.second));
+        if (!inserted) {
+            combine(it->second, std::move(entry.second));
         }
-        return num_steps;
     }
+}
 
-    template <typename FnT>
-    size_t advance_while(FnT const& fn, bool expected)
-    {
-        size_t num_steps = 0;
-        auto& self = downcast();
-        while ((!self.empty()) && (fn(self.get()) == expected)) {
-            self.next();
-            ++num_steps;
-        }
-        return num_steps;
-    }
+template <typename T>
+class [[nodiscard]] Iterator;
 
-    template <typename FnT>
-    size_t advance_back_while(FnT const& fn, bool expected)
-    {
-        size_t num_steps = 0;
-        auto& self = downcast();
-        while ((!self.empty()) && (fn(self.get_back()) == expected)) {
-            self.next_back();
-            ++num_steps;
-        }
-        return num_steps;
-    }
+template <typename T, typename CompareT>
+class [[nodiscard]] KMerge;
 
-    T m_iter;
+template <typename T, typename U>
+class [[nodiscard]] Chain;
 
-private:
-    template <typename FnT>
-    bool any_or_all(FnT const& fn, bool b)
-    {
-        for (auto& self = downcast(); !self.empty();) {
-            if (fn(self.next()) == b) {
-                return b;
+template <typename T, typename... Us>
+class [[nodiscard]] ChainAll;
+
+template <typename T, bool Exact>
+class [[nodiscard]] Chunks;
+
+template <typename T>
+class [[nodiscard]] Dedup;
+
+template <typename T>
+class [[nodiscard]] Enumerate;
+
+template <typename T, typename FnT>
+class [[nodiscard]] Filter;
+
+template <typename T>
+class [[nodiscard]] Flatten;
+
+template <typename T, typename FnT>
+class [[nodiscard]] Inspect;
+
+template <typename T, size_t N>
+class [[nodiscard]] Lookahead;
+
+template <typename T, typename FnT>
+class [[nodiscard]] Map;
+
+template <typename T, typename FnT>
+class [[nodiscard]] MapCached;
+
+template <typename T, typename FnT>
+class [[nodiscard]] MapWhile;
+
+enum class MergeOp { Merge, Union, Intersection, Difference };
+
+template <typename T, typename U, typename CompareT, MergeOp Op>
+class [[nodiscard]] Merge;
+
+template <typename T>
+class [[nodiscard]] ParBridge;
+
+template <typename T>
+class [[nodiscard]] PipelineStage;
+
+template <typename T, typename SinkT>
+class [[nodiscard]] Profile;
+
+#if defined(__cpp_lib_ranges)
+template <typename T>
+class [[nodiscard]] RangeView;
+#endif
+
+template <typename T>
+class [[nodiscard]] Reverse;
+
+template <typename T>
+class [[nodiscard]] Skip;
+
+template <typename T, typename FnT>
+class [[nodiscard]] SkipWhile;
+
+template <typename T, typename CompareT>
+class [[nodiscard]] Sorted;
+
+template <typename T>
+class [[nodiscard]] StepBy;
+
+template <typename T>
+class [[nodiscard]] Take;
+
+template <typename T, typename FnT>
+class [[nodiscard]] TakeWhile;
+
+template <typename T, typename SetT>
+class [[nodiscard]] Unique;
+
+template <typename T, typename U>
+class [[nodiscard]] WithExecutor;
+
+template <typename T>
+class [[nodiscard]] Windows;
+
+template <typename T, typename U>
+class [[nodiscard]] Zip;
+
+template <typename T, typename... Us>
+class [[nodiscard]] ZipAll;
+
+/// An executor runs two callables, possibly in parallel, and returns once both have completed:
+///   size_t concurrency() const;
+///   template <typename F, typename G> void join(F&& f, G&& g);
+template <typename T, typename = void>
+constexpr bool IsExecutorV = false;
+
+template <typename T>
+constexpr bool IsExecutorV<
+    T,
+    std::void_t<
+        decltype(size_t{std::declval<T const&>().concurrency()}),
+        decltype(std::declval<T&>().join(std::declval<void (&)()>(), std::declval<void (&)()>()))>> = true;
+
+/// A scheduler runs a callable later, on a thread of its choosing, such as the event loop of an I/O library:
+///   template <typename F> void post(F&& f);
+template <typename T, typename = void>
+constexpr bool IsSchedulerV = false;
+
+template <typename T>
+constexpr bool IsSchedulerV<T, std::void_t<decltype(std::declval<T&>().post(std::declval<void (&)()>()))>> = true;
+
+template <typename ExecT>
+struct Execution final {
+    ExecT* executor;
+    size_t grain; // minimum number of elements per part
+};
+
+/// Work-stealing pool: every worker owns a deque of jobs, pops its newest job and steals the oldest (and
+/// therefore largest) job of another worker when it runs dry. Threads calling join() from outside the pool
+/// queue their jobs on a shared injector deque and help executing jobs while they wait.
+class ThreadPool final {
+public:
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    explicit ThreadPool(size_t num_workers)
+    : m_queues(num_workers + 1)
+    {
+        m_workers.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            m_workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    static ThreadPool& global()
+    {
+        static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return pool;
+    }
+
+    /// worker threads plus the joining thread
+    size_t concurrency() const { return m_workers.size() + 1; }
+
+    template <typename F, typename G>
+    void join(F&& f, G&& g)
+    {
+        using JobFnT = std::remove_reference_t<G>;
+        Job job(
+            [](void* context) { (*static_cast<JobFnT*>(context))(); },
+            const_cast<void*>(static_cast<void const*>(std::addressof(g))));
+        Queue& queue = local_queue();
+        push(queue, &job);
+
+        std::exception_ptr error;
+        try {
+            f();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        if (reclaim(queue, &job)) {
+            job.run();
+        }
+        while (!job.done.load(std::memory_order_acquire)) {
+            if (Job* other = find_job(queue)) {
+                other->run();
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job final {
+        Job(void (*fn)(void*), void* ctx)
+        : invoke(fn)
+        , context(ctx)
+        {
+        }
+
+        void (*invoke)(void*);
+        void* context;
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+
+        void run()
+        {
+            try {
+                invoke(context);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            done.store(true, std::memory_order_release);
+        }
+    };
+
+    struct Queue final {
+        std::mutex mutex;
+        std::deque<Job*> jobs;
+    };
+
+    Queue& local_queue()
+    {
+        // the last queue is shared by every thread outside of the pool
+        return (t_pool == this) ? m_queues[t_index] : m_queues.back();
+    }
+
+    void push(Queue& queue, Job* job)
+    {
+        m_pending.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    bool reclaim(Queue& queue, Job* job)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        auto const found = std::find(queue.jobs.rbegin(), queue.jobs.rend(), job);
+        if (found == queue.jobs.rend()) {
+            return false;
+        }
+        queue.jobs.erase(std::next(found).base());
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* find_job(Queue& own)
+    {
+        if (m_pending.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+        if (Job* job = pop(own, true)) {
+            return job;
+        }
+        size_t const start = (t_pool == this) ? t_index + 1 : 0;
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            if (Job* job = pop(m_queues[(start + i) % m_queues.size()], false)) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    Job* pop(Queue& queue, bool newest)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            return nullptr;
+        }
+        Job* job = newest ? queue.jobs.back() : queue.jobs.front();
+        newest ? queue.jobs.pop_back() : queue.jobs.pop_front();
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    void work(size_t index)
+    {
+        t_pool = this;
+        t_index = index;
+        for (;;) {
+            if (Job* job = find_job(m_queues[index])) {
+                job->run();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stop || (m_pending.load(std::memory_order_acquire) != 0); });
+            if (m_stop) {
+                return;
+            }
+        }
+    }
+
+    static inline thread_local ThreadPool* t_pool = nullptr;
+    static inline thread_local size_t t_index = 0;
+
+    std::vector<Queue> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_pending{0};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
+
+#if defined(ITERATOR_ADAPTERS_PROFILE) && ITERATOR_ADAPTERS_PROFILE
+constexpr bool ProfilingV = true;
+#else
+constexpr bool ProfilingV = false; // profile() stages compile to nothing
+#endif
+
+/// elements produced by the stages upstream of a profile() stage, and the time spent producing them
+struct ProfileStats final {
+    size_t elements = 0;
+    std::chrono::nanoseconds time{0};
+};
+
+/// The counters of a profile() stage, reported to its sink when the stage is destroyed. The "in" side is the
+/// nearest profile() stage further upstream in the same chain (if any), so that a Filter between the two stages has
+/// a selectivity of elements_out / elements_in and takes time - upstream_time. The name is a copy, so that the records
+/// that a sink keeps outlive the name that was passed to profile().
+struct ProfileRecord final {
+    std::string name;
+    size_t elements_in = 0;
+    size_t elements_out = 0;
+    std::chrono::nanoseconds time{0};
+    std::chrono::nanoseconds upstream_time{0};
+
+    double selectivity() const
+    {
+        return (elements_in != 0) ? (static_cast<double>(elements_out) / static_cast<double>(elements_in)) : 1.0;
+    }
+
+    std::chrono::nanoseconds self_time() const { return time - upstream_time; }
+};
+
+/// profile() sink that sums up the records by name, such as those of the parts of a parallel terminal
+class ProfileCounters final {
+public:
+    ProfileCounters() = default;
+
+    ProfileCounters(ProfileCounters const&) = delete;
+    ProfileCounters& operator=(ProfileCounters const&) = delete;
+
+    /// the default sink of profile()
+    static ProfileCounters& global()
+    {
+        static ProfileCounters counters;
+        return counters;
+    }
+
+    void operator()(ProfileRecord const& record)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto const it = std::find_if(m_records.begin(), m_records.end(), [&record](ProfileRecord const& r) {
+            return r.name == record.name;
+        });
+        if (it == m_records.end()) {
+            m_records.push_back(record);
+        }
+        else {
+            it->elements_in += record.elements_in;
+            it->elements_out += record.elements_out;
+            it->time += record.time;
+            it->upstream_time += record.upstream_time;
+        }
+    }
+
+    /// in the order in which the names were first reported
+    std::vector<ProfileRecord> records() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_records;
+    }
+
+    std::optional<ProfileRecord> find(std::string_view name) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto const& record : m_records) {
+            if (record.name == name) {
+                return record;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_records.clear();
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<ProfileRecord> m_records;
+};
+
+/// the owner of sources that borrow their elements
+struct NoOwner final {};
+
+/// Borrows the elements of a container, or shares the ownership of it when Owning
+template <typename T, typename IterT, bool Owning = false>
+class [[nodiscard]] IterPair final {
+    // borrowing pairs hold no owner, so that they stay literal types and can be used in constant expressions
+    using OwnerT = std::conditional_t<Owning, std::shared_ptr<void const>, NoOwner>;
+
+public:
+    MOVE_ONLY(IterPair);
+
+    ALL_FRIEND;
+
+    using value_type = decltype(*std::declval<IterT>());
+    using std_iterator = IterT;
+    using mut_or_const_iterator = IterT;
+
+    static constexpr bool random_access = IsRandomAccessV<IterT>;
+    static constexpr bool bidirectional = IsBidirectionalV<IterT>;
+    static constexpr bool exact_size = true;
+    static constexpr bool splittable = random_access;
+    static constexpr bool indexed = random_access;
+    static constexpr bool bridged = false;
+    static constexpr bool contiguous = IsContiguousV<T, IterT>;
+    static constexpr bool contiguous_source = contiguous;
+
+    static_assert(std::is_reference_v<value_type>);
+
+    constexpr explicit IterPair(T const& t)
+    : m_iter(t.begin())
+    , m_end(t.end())
+    {
+    }
+
+    constexpr explicit IterPair(T& t)
+    : m_iter(t.begin())
+    , m_end(t.end())
+    {
+    }
+
+    explicit IterPair(T&& t) = delete;
+
+    /// keeps the container alive for as long as any part of the range is
+    template <typename U>
+    explicit IterPair(std::shared_ptr<U> owner)
+    : m_iter(owner->begin())
+    , m_end(owner->end())
+    , m_owner(std::move(owner))
+    {
+        static_assert(Owning, "Only owning pairs keep their container");
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const
+    {
+        size_t const n = distance();
+        return {n, n};
+    }
+
+private:
+    constexpr IterPair(mut_or_const_iterator begin, mut_or_const_iterator end, OwnerT owner)
+    : m_iter(begin)
+    , m_end(end)
+    , m_owner(std::move(owner))
+    {
+    }
+
+    constexpr bool empty() const { return m_iter == m_end; }
+
+    constexpr size_t distance() const { return static_cast<size_t>(std::distance(m_iter, m_end)); }
+
+    constexpr value_type get() { return *m_iter; }
+
+    constexpr value_type get_at(size_t n) { return *std::next(m_iter, static_cast<std::ptrdiff_t>(n)); }
+
+    constexpr auto data() const { return std::addressof(*m_iter); }
+
+    constexpr auto source() const /* -> Span */
+    {
+        using SourceT = Span<std::remove_reference_t<value_type>>;
+        return empty() ? SourceT{} : SourceT{data(), distance()};
+    }
+
+    template <typename U, typename SinkT>
+    constexpr void visit(U&& item, SinkT&& sink)
+    {
+        sink(item);
+    }
+
+    constexpr value_type get_back()
+    {
+        if constexpr (IsBidirectionalV<IterT>) {
+            auto copy = m_end;
+            return *(--copy);
+        }
+        else {
+            return *m_end;
+        }
+    }
+
+    constexpr value_type next()
+    {
+        value_type item = *m_iter;
+        ++m_iter;
+        return std::forward<value_type>(item);
+    }
+
+    constexpr value_type next_back()
+    {
+        if constexpr (IsBidirectionalV<IterT>) {
+            --m_end;
+        }
+        return *m_end;
+    }
+
+    constexpr void stop_iteration() { m_iter = m_end; }
+
+    constexpr size_t advance_by(size_t n)
+    {
+        if constexpr (random_access) {
+            size_t const num_steps = std::min(n, distance());
+            m_iter = std::next(m_iter, static_cast<std::ptrdiff_t>(num_steps));
+            return num_steps;
+        }
+        else {
+            size_t num_steps = 0;
+            for (; (!empty()) && (num_steps < n); ++num_steps) {
+                ++m_iter;
+            }
+            return num_steps;
+        }
+    }
+
+    constexpr size_t advance_back_by(size_t n)
+    {
+        if constexpr (random_access) {
+            size_t const num_steps = std::min(n, distance());
+            m_end = std::prev(m_end, static_cast<std::ptrdiff_t>(num_steps));
+            return num_steps;
+        }
+        else {
+            size_t num_steps = 0;
+            for (; (!empty()) && (num_steps < n); ++num_steps) {
+                next_back();
+            }
+            return num_steps;
+        }
+    }
+
+    constexpr size_t split_size() const { return distance(); }
+
+    constexpr Execution<ThreadPool> execution() const { return {&ThreadPool::global(), 1}; }
+
+    constexpr ProfileStats const* profile_stats() const { return nullptr; }
+
+    constexpr IterPair split_front(size_t n)
+    {
+        auto const begin = m_iter;
+        advance_by(n);
+        return IterPair(begin, m_iter, m_owner);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn)
+    {
+        while (m_iter != m_end) {
+            value_type item = *m_iter;
+            ++m_iter;
+            if (!fn(acc, std::forward<value_type>(item))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn)
+    {
+        while (m_iter != m_end) {
+            if (!fn(acc, next_back())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    mut_or_const_iterator m_iter;
+    mut_or_const_iterator m_end;
+    OwnerT m_owner;
+};
+
+/// Protocol defaults of the sources that generate their elements instead of reading them from a container.
+template <typename SourceT>
+class SourceBase {
+public:
+    MOVE_ONLY(SourceBase);
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+    static constexpr bool indexed = false;
+    static constexpr bool bridged = false;
+    static constexpr bool contiguous = false;
+    static constexpr bool contiguous_source = false;
+
+protected:
+    constexpr SourceBase() = default;
+
+    ~SourceBase() = default;
+
+    /* virtual */ constexpr Execution<ThreadPool> execution() const { return {&ThreadPool::global(), 1}; }
+
+    /* virtual */ constexpr ProfileStats const* profile_stats() const { return nullptr; }
+
+    /* virtual */ constexpr size_t advance_by(size_t n)
+    {
+        size_t num_steps = 0;
+        for (auto& self = downcast(); (!self.empty()) && (num_steps < n); ++num_steps) {
+            self.next();
+        }
+        return num_steps;
+    }
+
+    /* virtual */ constexpr size_t advance_back_by(size_t n)
+    {
+        size_t num_steps = 0;
+        for (auto& self = downcast(); (!self.empty()) && (num_steps < n); ++num_steps) {
+            self.next_back();
+        }
+        return num_steps;
+    }
+
+    template <typename AccT, typename FnT>
+    /* virtual */ constexpr bool try_fold(AccT& acc, FnT&& fn)
+    {
+        for (auto& self = downcast(); !self.empty();) {
+            if (!fn(acc, self.next())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT>
+    /* virtual */ constexpr bool try_rfold(AccT& acc, FnT&& fn)
+    {
+        for (auto& self = downcast(); !self.empty();) {
+            if (!fn(acc, self.next_back())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    constexpr SourceT& downcast() { return *static_cast<SourceT*>(this); }
+};
+
+/// first, first + step, ... up to but excluding last, the elements are computed from their index so that floating
+/// point steps do not accumulate rounding errors. A descending range of an unsigned type has the negative step
+/// wrapped around, which computes the same elements modulo the width of the type.
+template <typename T>
+class [[nodiscard]] Range final : public SourceBase<Range<T>> {
+public:
+    MOVE_ONLY(Range);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    static constexpr bool random_access = true;
+    static constexpr bool bidirectional = true;
+    static constexpr bool exact_size = true;
+    static constexpr bool splittable = true;
+    static constexpr bool indexed = true;
+
+    static_assert(std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>), "Arithmetic type required");
+
+    constexpr Range(T first, T last, T step)
+    : Range(first, last, step, !(step > T{0}))
+    {
+    }
+
+    constexpr Range(T first, T last, T step, bool descending)
+    : m_first(first)
+    , m_step(step)
+    , m_end(count(first, last, step, descending))
+    {
+        assert(step != T{0});
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        size_t const n = distance();
+        return {n, n};
+    }
+
+private:
+    constexpr Range(T first, T step, size_t front, size_t end)
+    : m_first(first)
+    , m_step(step)
+    , m_front(front)
+    , m_end(end)
+    {
+    }
+
+    static constexpr size_t count(T first, T last, T step, bool descending)
+    {
+        if (!(descending ? (last < first) : (first < last))) {
+            return 0;
+        }
+        if constexpr (std::is_integral_v<T>) {
+            using U = AccumulatorT<T>;
+            using UnsignedT = std::make_unsigned_t<T>;
+            U const span = descending ? (U(first) - U(last)) : (U(last) - U(first));
+            // negated in the width of T, which is the step of an unsigned range before it wrapped around
+            U const stride =
+                descending ? U(static_cast<UnsignedT>(UnsignedT{0} - static_cast<UnsignedT>(step))) : U(step);
+            return static_cast<size_t>((span - 1) / stride + 1);
+        }
+        else {
+            T const steps = (last - first) / step;
+            if (!(steps < static_cast<T>(static_cast<size_t>(-1) / 2))) {
+                return static_cast<size_t>(-1) / 2;
+            }
+            auto const inside = [=](size_t i) {
+                T const value = first + static_cast<T>(i) * step;
+                return (step > T{0}) ? (value < last) : (last < value);
+            };
+            auto n = static_cast<size_t>(steps);
+            while (inside(n)) {
+                ++n;
+            }
+            while ((n != 0) && (!inside(n - 1))) {
+                --n;
+            }
+            return n;
+        }
+    }
+
+    constexpr T at(size_t i) const
+    {
+        if constexpr (std::is_integral_v<T>) {
+            using U = AccumulatorT<T>;
+            return static_cast<T>(U(m_first) + static_cast<U>(i) * U(m_step));
+        }
+        else {
+            return m_first + static_cast<T>(i) * m_step;
+        }
+    }
+
+    constexpr bool empty() const { return m_front == m_end; }
+
+    constexpr size_t distance() const { return m_end - m_front; }
+
+    constexpr T get() const { return at(m_front); }
+
+    constexpr T get_back() const { return at(m_end - 1); }
+
+    constexpr T get_at(size_t n) const { return at(m_front + n); }
+
+    constexpr T next() { return at(m_front++); }
+
+    constexpr T next_back() { return at(--m_end); }
+
+    constexpr void stop_iteration() { m_front = m_end; }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        size_t const num_steps = std::min(n, distance());
+        m_front += num_steps;
+        return num_steps;
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        size_t const num_steps = std::min(n, distance());
+        m_end -= num_steps;
+        return num_steps;
+    }
+
+    constexpr size_t split_size() const { return distance(); }
+
+    constexpr Range split_front(size_t n)
+    {
+        size_t const front = m_front;
+        advance_by(n);
+        return Range(m_first, m_step, front, m_front);
+    }
+
+    T m_first;
+    T m_step;
+    size_t m_front = 0;
+    size_t m_end;
+};
+
+/// the same value over and over again
+template <typename T>
+class [[nodiscard]] Repeat final : public SourceBase<Repeat<T>> {
+public:
+    MOVE_ONLY(Repeat);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    static constexpr bool random_access = true;
+    static constexpr bool bidirectional = true;
+
+    constexpr explicit Repeat(T&& value)
+    : m_value(std::move(value))
+    {
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        return empty() ? SizeHint{0, 0} : SizeHint{static_cast<size_t>(-1), std::nullopt};
+    }
+
+private:
+    constexpr bool empty() const { return !m_value; }
+
+    constexpr T get() const { return *m_value; }
+
+    constexpr T get_back() const { return *m_value; }
+
+    constexpr T next() { return *m_value; }
+
+    constexpr T next_back() { return *m_value; }
+
+    constexpr void stop_iteration() { m_value.reset(); }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return empty() ? 0 : n; }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return empty() ? 0 : n; }
+
+    std::optional<T> m_value;
+};
+
+/// the values of a generator returning std::optional, until it returns std::nullopt
+template <typename FnT>
+class [[nodiscard]] FromFn final : public SourceBase<FromFn<FnT>> {
+public:
+    MOVE_ONLY(FromFn);
+
+    ALL_FRIEND;
+
+    using value_type = typename std::invoke_result_t<FnT&>::value_type;
+
+    static_assert(IsOptionalV<std::invoke_result_t<FnT&>>, "Generator must return std::optional");
+
+    constexpr explicit FromFn(FnT&& fn)
+    : m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        size_t const n = m_next ? 1 : 0;
+        return {n, m_done ? std::optional<size_t>(n) : std::nullopt};
+    }
+
+private:
+    constexpr bool empty() const
+    {
+        // the generator is only called once its value is needed
+        return !const_cast<FromFn&>(*this).fill();
+    }
+
+    constexpr value_type get()
+    {
+        fill();
+        return *m_next;
+    }
+
+    constexpr value_type next()
+    {
+        fill();
+        value_type item = std::move(*m_next);
+        m_next.reset();
+        return item;
+    }
+
+    constexpr void stop_iteration()
+    {
+        m_next.reset();
+        m_done = true;
+    }
+
+    constexpr bool fill()
+    {
+        if ((!m_next) && (!m_done)) {
+            m_next = m_f();
+            m_done = !m_next;
+        }
+        return m_next.has_value();
+    }
+
+    FnT m_f;
+    std::optional<value_type> m_next;
+    bool m_done = false;
+};
+
+/// first, fn(first), fn(fn(first)), ... until fn returns std::nullopt, or forever when fn returns plain values
+template <typename T, typename FnT>
+class [[nodiscard]] Successors final : public SourceBase<Successors<T, FnT>> {
+public:
+    MOVE_ONLY(Successors);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    static_assert(std::is_invocable_v<FnT, T const&>, "Invocable required");
+
+    constexpr Successors(std::optional<T>&& first, FnT&& fn)
+    : m_next(std::move(first))
+    , m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        if (!m_next) {
+            return {0, 0};
+        }
+        if constexpr (IsOptionalV<std::invoke_result_t<FnT, T const&>>) {
+            return {1, std::nullopt};
+        }
+        else {
+            return {static_cast<size_t>(-1), std::nullopt};
+        }
+    }
+
+private:
+    constexpr bool empty() const { return !m_next; }
+
+    constexpr T get() { return *m_next; }
+
+    constexpr T next()
+    {
+        T item = std::move(*m_next);
+        if constexpr (IsOptionalV<std::invoke_result_t<FnT, T const&>>) {
+            m_next = m_f(std::as_const(item));
+        }
+        else {
+            m_next.emplace(m_f(std::as_const(item)));
+        }
+        return item;
+    }
+
+    constexpr void stop_iteration() { m_next.reset(); }
+
+    std::optional<T> m_next;
+    FnT m_f;
+};
+
+/// a single value
+template <typename T>
+class [[nodiscard]] Once final : public SourceBase<Once<T>> {
+public:
+    MOVE_ONLY(Once);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    static constexpr bool random_access = true;
+    static constexpr bool bidirectional = true;
+    static constexpr bool exact_size = true;
+
+    constexpr explicit Once(T&& value)
+    : m_value(std::move(value))
+    {
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        size_t const n = distance();
+        return {n, n};
+    }
+
+private:
+    constexpr bool empty() const { return !m_value; }
+
+    constexpr size_t distance() const { return m_value ? 1 : 0; }
+
+    constexpr T get() const { return *m_value; }
+
+    constexpr T get_back() const { return *m_value; }
+
+    constexpr T next()
+    {
+        T item = std::move(*m_value);
+        m_value.reset();
+        return item;
+    }
+
+    constexpr T next_back() { return next(); }
+
+    constexpr void stop_iteration() { m_value.reset(); }
+
+    std::optional<T> m_value;
+};
+
+#if defined(__cpp_lib_ranges)
+/// The elements of a view. Views whose iterators refer to the view itself, such as std::views::filter, are kept on
+/// the heap so that they stay in place while the adapter is moved; borrowed ranges are not kept at all.
+template <typename ViewT>
+class [[nodiscard]] FromRange final : public SourceBase<FromRange<ViewT>> {
+    using IterT = std::ranges::iterator_t<ViewT>;
+    using SentinelT = std::ranges::sentinel_t<ViewT>;
+    using OwnerT = std::conditional_t<std::ranges::borrowed_range<ViewT>, NoOwner, std::unique_ptr<ViewT>>;
+
+public:
+    MOVE_ONLY(FromRange);
+
+    ALL_FRIEND;
+
+    using value_type = std::iter_reference_t<IterT>;
+
+    static constexpr bool random_access =
+        std::random_access_iterator<IterT> && std::sized_sentinel_for<SentinelT, IterT>;
+    static constexpr bool bidirectional = std::bidirectional_iterator<IterT> && std::same_as<IterT, SentinelT>;
+    static constexpr bool exact_size = std::sized_sentinel_for<SentinelT, IterT>;
+    static constexpr bool indexed = random_access;
+
+    explicit FromRange(ViewT&& view)
+    : m_owner(own(std::move(view)))
+    , m_iter(std::ranges::begin(elements(view)))
+    , m_end(std::ranges::end(elements(view)))
+    {
+    }
+
+    SizeHint size_hint() const
+    {
+        if constexpr (exact_size) {
+            size_t const n = distance();
+            return {n, n};
+        }
+        else {
+            return {empty() ? 0 : 1, std::nullopt};
+        }
+    }
+
+private:
+    static OwnerT own(ViewT&& view)
+    {
+        if constexpr (std::ranges::borrowed_range<ViewT>) {
+            return {};
+        }
+        else {
+            return std::make_unique<ViewT>(std::move(view));
+        }
+    }
+
+    ViewT& elements(ViewT& view)
+    {
+        if constexpr (std::ranges::borrowed_range<ViewT>) {
+            return view;
+        }
+        else {
+            return *m_owner;
+        }
+    }
+
+    bool empty() const { return m_stopped || (m_iter == m_end); }
+
+    size_t distance() const { return static_cast<size_t>(m_end - m_iter); }
+
+    value_type get() { return *m_iter; }
+
+    value_type get_at(size_t n) { return m_iter[static_cast<std::iter_difference_t<IterT>>(n)]; }
+
+    value_type get_back()
+    {
+        auto copy = m_end;
+        return *(--copy);
+    }
+
+    value_type next()
+    {
+        value_type item = *m_iter;
+        ++m_iter;
+        return std::forward<value_type>(item);
+    }
+
+    value_type next_back() { return *(--m_end); }
+
+    void stop_iteration()
+    {
+        // unbounded views such as std::views::iota(0) never reach their sentinel
+        if constexpr (std::assignable_from<IterT&, SentinelT> || exact_size) {
+            std::ranges::advance(m_iter, m_end);
+        }
+        else {
+            m_stopped = true;
+        }
+    }
+
+    size_t advance_by(size_t n) /* override */
+    {
+        if constexpr (random_access) {
+            size_t const num_steps = std::min(n, distance());
+            m_iter += static_cast<std::ptrdiff_t>(num_steps);
+            return num_steps;
+        }
+        else {
+            size_t num_steps = 0;
+            for (; (!empty()) && (num_steps < n); ++num_steps) {
+                ++m_iter;
+            }
+            return num_steps;
+        }
+    }
+
+    size_t advance_back_by(size_t n) /* override */
+    {
+        if constexpr (random_access) {
+            size_t const num_steps = std::min(n, distance());
+            m_end -= static_cast<std::ptrdiff_t>(num_steps);
+            return num_steps;
+        }
+        else {
+            size_t num_steps = 0;
+            for (; (!empty()) && (num_steps < n); ++num_steps) {
+                --m_end;
+            }
+            return num_steps;
+        }
+    }
+
+    OwnerT m_owner;
+    IterT m_iter;
+    SentinelT m_end;
+    bool m_stopped = false;
+};
+#endif
+
+#if defined(__cpp_lib_coroutine)
+template <typename T>
+class FromGenerator;
+
+/// Coroutine that produces the elements of from_generator() with co_yield. It starts once the first element is needed
+/// and is suspended in between, so the elements are produced one at a time; its exceptions reach the caller.
+template <typename T>
+class [[nodiscard]] Generator final {
+public:
+    struct promise_type final {
+        // not an aggregate, which the coroutine arguments would initialize
+        promise_type() = default;
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(T item)
+        {
+            value.emplace(std::move(item));
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() { error = std::current_exception(); }
+
+        std::optional<T> value;
+        std::exception_ptr error;
+    };
+
+    Generator(Generator const&) = delete;
+    Generator& operator=(Generator const&) = delete;
+
+    Generator(Generator&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        std::swap(m_handle, other.m_handle);
+        return *this;
+    }
+
+    ~Generator() { reset(); }
+
+private:
+    friend class FromGenerator<T>;
+
+    explicit Generator(std::coroutine_handle<promise_type> handle)
+    : m_handle(handle)
+    {
+    }
+
+    void reset()
+    {
+        if (m_handle) {
+            std::exchange(m_handle, nullptr).destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/// the elements of a Generator, the coroutine is resumed whenever the next one is needed and destroyed once the
+/// adapter stops
+template <typename T>
+class [[nodiscard]] FromGenerator final : public SourceBase<FromGenerator<T>> {
+public:
+    MOVE_ONLY(FromGenerator);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    explicit FromGenerator(Generator<T>&& generator)
+    : m_generator(std::move(generator))
+    {
+    }
+
+    SizeHint size_hint() const
+    {
+        auto const handle = m_generator.m_handle;
+        size_t const n = (handle && handle.promise().value) ? 1 : 0;
+        return {n, (handle && !handle.done()) ? std::nullopt : std::optional<size_t>(n)};
+    }
+
+private:
+    bool empty() const
+    {
+        // the coroutine is only resumed once its element is needed
+        return !const_cast<FromGenerator&>(*this).fill();
+    }
+
+    T get()
+    {
+        fill();
+        return *m_generator.m_handle.promise().value;
+    }
+
+    T next()
+    {
+        fill();
+        auto& value = m_generator.m_handle.promise().value;
+        T item = std::move(*value);
+        value.reset();
+        return item;
+    }
+
+    void stop_iteration() { m_generator.reset(); }
+
+    bool fill()
+    {
+        auto const handle = m_generator.m_handle;
+        if (!handle) {
+            return false;
+        }
+        auto& promise = handle.promise();
+        if ((!promise.value) && (!handle.done())) {
+            handle.resume();
+            if (promise.error) {
+                auto const error = promise.error;
+                m_generator.reset();
+                std::rethrow_exception(error);
+            }
+        }
+        return promise.value.has_value();
+    }
+
+    Generator<T> m_generator;
+};
+
+template <typename T, typename SchedulerT>
+class FromAsync;
+
+/// Coroutine that produces the elements of from_async() with co_yield and may co_await any awaitable in between, such
+/// as a read from a socket. Unlike a Generator it runs ahead of the adapter into a buffer, and only waits for the
+/// adapter once the buffer is full; its exceptions reach the adapter after the elements produced before them.
+template <typename T>
+class [[nodiscard]] AsyncGenerator final {
+    // Suspended: before the start, or on a full buffer (the adapter resumes it then), Running: resumed, or suspended
+    // in an awaitable that resumes it, Done: at the final suspend point
+    enum class State { Suspended, Running, Done };
+
+    // shared by the coroutine and the adapter, so that either one may stop first
+    struct Channel final {
+        std::mutex mutex;
+        std::condition_variable produced;
+        std::deque<T> buffer;
+        size_t capacity = 1;
+        std::exception_ptr error;
+        State state = State::Suspended;
+        bool cancelled = false; // the adapter stopped, a running coroutine destroys itself at its next co_yield
+    };
+
+    struct YieldAwaiter final {
+        bool await_ready() const noexcept { return false; }
+
+        // keeps running as long as the buffer has room, the adapter may resume it once the state is Suspended
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::unique_lock<std::mutex> lock(channel->mutex);
+            if (channel->cancelled) {
+                lock.unlock();
+                handle.destroy();
+                return true;
+            }
+            channel->buffer.push_back(std::move(item));
+            channel->produced.notify_one();
+            if (channel->buffer.size() < channel->capacity) {
+                return false;
+            }
+            channel->state = State::Suspended;
+            return true;
+        }
+
+        void await_resume() const noexcept {}
+
+        Channel* channel;
+        T item;
+    };
+
+    struct FinalAwaiter final {
+        bool await_ready() const noexcept { return false; }
+
+        // a cancelled coroutine runs off its end, which destroys it
+        bool await_suspend(std::coroutine_handle<>) const noexcept
+        {
+            std::lock_guard<std::mutex> lock(channel->mutex);
+            channel->state = State::Done;
+            channel->produced.notify_one();
+            return !channel->cancelled;
+        }
+
+        void await_resume() const noexcept {}
+
+        Channel* channel;
+    };
+
+public:
+    struct promise_type final {
+        promise_type()
+        : channel(std::make_shared<Channel>())
+        {
+        }
+
+        AsyncGenerator get_return_object()
+        {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this), channel);
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        FinalAwaiter final_suspend() noexcept { return {channel.get()}; }
+
+        YieldAwaiter yield_value(T item) { return {channel.get(), std::move(item)}; }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            std::lock_guard<std::mutex> lock(channel->mutex);
+            channel->error = std::current_exception();
+        }
+
+        std::shared_ptr<Channel> channel;
+    };
+
+    AsyncGenerator(AsyncGenerator const&) = delete;
+    AsyncGenerator& operator=(AsyncGenerator const&) = delete;
+
+    AsyncGenerator(AsyncGenerator&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, nullptr))
+    , m_channel(std::move(other.m_channel))
+    {
+    }
+
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept
+    {
+        std::swap(m_handle, other.m_handle);
+        std::swap(m_channel, other.m_channel);
+        return *this;
+    }
+
+    ~AsyncGenerator() { reset(); }
+
+private:
+    template <typename U, typename SchedulerT>
+    friend class FromAsync;
+
+    AsyncGenerator(std::coroutine_handle<promise_type> handle, std::shared_ptr<Channel> channel)
+    : m_handle(handle)
+    , m_channel(std::move(channel))
+    {
+    }
+
+    // a running coroutine cannot be destroyed from here, it is left to destroy itself
+    void reset()
+    {
+        if (!m_handle) {
+            return;
+        }
+        auto const handle = std::exchange(m_handle, nullptr);
+        bool running = false;
+        {
+            std::lock_guard<std::mutex> lock(m_channel->mutex);
+            m_channel->cancelled = true;
+            m_channel->buffer.clear();
+            running = (m_channel->state == State::Running);
+        }
+        if (!running) {
+            handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+    std::shared_ptr<Channel> m_channel;
+};
+
+/// The elements of an AsyncGenerator. The coroutine is started through the scheduler once the first element is
+/// needed, and from then on fills a buffer of up to capacity elements while the stages after it work on the elements
+/// taken off the buffer before. It is resumed through the scheduler whenever it waits for room, and the adapter only
+/// blocks once the buffer is empty, so it must not run as a job of a scheduler that the coroutine depends on.
+template <typename T, typename SchedulerT>
+class [[nodiscard]] FromAsync final : public SourceBase<FromAsync<T, SchedulerT>> {
+    using Channel = typename AsyncGenerator<T>::Channel;
+    using State = typename AsyncGenerator<T>::State;
+
+public:
+    MOVE_ONLY(FromAsync);
+
+    ALL_FRIEND;
+
+    using value_type = T;
+
+    FromAsync(AsyncGenerator<T>&& generator, SchedulerT& scheduler, size_t capacity)
+    : m_generator(std::move(generator))
+    , m_scheduler(&scheduler)
+    {
+        m_generator.m_channel->capacity = std::max<size_t>(capacity, 1);
+    }
+
+    /// the elements taken off the buffer already
+    SizeHint size_hint() const
+    {
+        size_t const n = m_ready.size();
+        return {n, m_generator.m_handle ? std::nullopt : std::optional<size_t>(n)};
+    }
+
+private:
+    bool empty() const { return !const_cast<FromAsync&>(*this).fill(); }
+
+    T get()
+    {
+        fill();
+        return m_ready.front();
+    }
+
+    T next()
+    {
+        fill();
+        T item = std::move(m_ready.front());
+        m_ready.pop_front();
+        return item;
+    }
+
+    void stop_iteration()
+    {
+        m_ready.clear();
+        m_generator.reset();
+    }
+
+    // takes the whole buffer once the elements taken before are consumed, false once the coroutine has finished
+    bool fill()
+    {
+        if (!m_ready.empty()) {
+            return true;
+        }
+        if (!m_generator.m_handle) {
+            return false;
+        }
+        Channel& channel = *m_generator.m_channel;
+        std::unique_lock<std::mutex> lock(channel.mutex);
+        resume(lock);
+        channel.produced.wait(lock, [&channel] { return !channel.buffer.empty() || (channel.state == State::Done); });
+        std::swap(m_ready, channel.buffer);
+        if (m_ready.empty()) {
+            auto const error = std::exchange(channel.error, nullptr);
+            lock.unlock();
+            m_generator.reset();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return false;
+        }
+        // the buffer has room again
+        resume(lock);
+        return true;
+    }
+
+    // the coroutine runs on a thread of the scheduler, never on the one of the adapter
+    void resume(std::unique_lock<std::mutex>& lock)
+    {
+        Channel& channel = *m_generator.m_channel;
+        if (channel.state != State::Suspended) {
+            return;
+        }
+        channel.state = State::Running;
+        lock.unlock();
+        try {
+            m_scheduler->post([handle = std::coroutine_handle<>(m_generator.m_handle)] { handle.resume(); });
+        }
+        catch (...) {
+            lock.lock();
+            channel.state = State::Suspended;
+            throw;
+        }
+        lock.lock();
+    }
+
+    AsyncGenerator<T> m_generator;
+    SchedulerT* m_scheduler;
+    std::deque<T> m_ready;
+};
+
+/// The completion of for_each_async(), awaited with co_await or wait(). The coroutine that awaits it is resumed on the
+/// thread that completed it, and the exception of the for_each() is rethrown from either.
+class [[nodiscard]] Completion final {
+    struct State final {
+        void complete(std::exception_ptr e)
+        {
+            std::coroutine_handle<> awaiting;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = e;
+                done = true;
+                awaiting = std::exchange(waiter, nullptr);
+                completed.notify_all();
+            }
+            if (awaiting) {
+                awaiting.resume();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable completed;
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+        bool done = false;
+    };
+
+public:
+    bool await_ready() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->done;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->done) {
+            return false;
+        }
+        m_state->waiter = handle;
+        return true;
+    }
+
+    void await_resume() const
+    {
+        if (m_state->error) {
+            std::rethrow_exception(m_state->error);
+        }
+    }
+
+    void wait() const
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            m_state->completed.wait(lock, [this] { return m_state->done; });
+        }
+        await_resume();
+    }
+
+private:
+    template <typename T, typename AdapterT>
+    friend class AdapterBase;
+
+    explicit Completion(std::shared_ptr<State> state)
+    : m_state(std::move(state))
+    {
+    }
+
+    std::shared_ptr<State> m_state;
+};
+#endif
+
+/// The elements of several adapters sorted by compare, in one sorted sequence. The adapters are kept in a binary heap
+/// ordered by their front elements, which are inspected with get(); equal elements come in the order of the adapters.
+template <typename T, typename CompareT>
+class [[nodiscard]] KMerge final : public SourceBase<KMerge<T, CompareT>> {
+public:
+    MOVE_ONLY(KMerge);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool exact_size = T::exact_size;
+
+    constexpr KMerge(std::vector<T>&& parts, CompareT&& compare)
+    : m_parts(std::move(parts))
+    , m_compare(std::forward<CompareT>(compare))
+    {
+        m_heap.reserve(m_parts.size());
+        for (size_t i = 0; i < m_parts.size(); ++i) {
+            if (!m_parts[i].empty()) {
+                m_heap.push_back(i);
+            }
+        }
+        std::make_heap(m_heap.begin(), m_heap.end(), later());
+    }
+
+    constexpr SizeHint size_hint() const
+    {
+        SizeHint hint{0, 0};
+        for (auto const& part : m_parts) {
+            auto const [lower, upper] = part.size_hint();
+            hint.first = (hint.first + lower < lower) ? static_cast<size_t>(-1) : (hint.first + lower);
+            if (hint.second && upper && (*hint.second + *upper >= *upper)) {
+                *hint.second += *upper;
+            }
+            else {
+                hint.second.reset();
+            }
+        }
+        return hint;
+    }
+
+private:
+    constexpr bool empty() const { return m_heap.empty(); }
+
+    constexpr size_t distance() const
+    {
+        size_t n = 0;
+        for (auto const& part : m_parts) {
+            n += part.distance();
+        }
+        return n;
+    }
+
+    constexpr value_type get() { return m_parts[m_heap.front()].get(); }
+
+    constexpr value_type next()
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later());
+        auto& part = m_parts[m_heap.back()];
+        value_type item = part.next();
+        if (part.empty()) {
+            m_heap.pop_back();
+        }
+        else {
+            std::push_heap(m_heap.begin(), m_heap.end(), later());
+        }
+        return std::forward<value_type>(item);
+    }
+
+    constexpr void stop_iteration()
+    {
+        for (auto& part : m_parts) {
+            part.stop_iteration();
+        }
+        m_heap.clear();
+    }
+
+    // whether adapter i comes after adapter j, which puts the first element at the front of the heap
+    constexpr auto later()
+    {
+        return [this](size_t i, size_t j) {
+            if (precedes(m_parts[j].get(), m_parts[i].get())) {
+                return true;
+            }
+            return (j < i) && !precedes(m_parts[i].get(), m_parts[j].get());
+        };
+    }
+
+    // the comparator sees const lvalues, an element that get() yields as an rvalue reference must not be moved out of
+    template <typename L, typename R>
+    constexpr bool precedes(L&& lhs, R&& rhs)
+    {
+        return m_compare(std::as_const(lhs), std::as_const(rhs));
+    }
+
+    std::vector<T> m_parts;
+    CompareT m_compare;
+    // the indices of the adapters that have elements left
+    std::vector<size_t> m_heap;
+};
+
+/// Hands the elements of a sequential adapter out to the parts of a parallel terminal. Every part takes batches from
+/// the shared upstream adapter under a lock and yields them from its own buffer, so parts with less work downstream
+/// take more batches, and the elements reach the terminal in no particular order.
+template <typename T>
+class [[nodiscard]] ParBridge final : public SourceBase<ParBridge<T>> {
+    using Slot = Fallible<typename T::value_type>;
+
+    struct Shared final {
+        explicit Shared(T&& t)
+        : iter(std::move(t))
+        {
+        }
+
+        std::mutex mutex;
+        T iter;
+    };
+
+public:
+    MOVE_ONLY(ParBridge);
+
+    ALL_FRIEND;
+
+    using value_type = std::conditional_t<
+        std::is_lvalue_reference_v<typename T::value_type>,
+        typename T::value_type,
+        std::decay_t<typename T::value_type>>;
+
+    static constexpr bool splittable = true;
+    static constexpr bool bridged = true;
+
+    ParBridge(T&& t, size_t batch)
+    : ParBridge(std::make_shared<Shared>(std::move(t)), batch, 2 * std::max(std::thread::hardware_concurrency(), 1u))
+    {
+    }
+
+    /// the elements buffered by this part, and at most all the elements left upstream on top
+    SizeHint size_hint() const
+    {
+        size_t const buffered = m_buffer.size() - m_pos;
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        auto const upper = m_shared->iter.size_hint().second;
+        bool const fits = upper && (*upper + buffered >= *upper);
+        return {buffered, fits ? std::optional<size_t>(*upper + buffered) : std::nullopt};
+    }
+
+private:
+    ParBridge(std::shared_ptr<Shared> shared, size_t batch, size_t parts)
+    : m_shared(std::move(shared))
+    , m_batch(std::max<size_t>(batch, 1))
+    , m_parts(parts)
+    {
+    }
+
+    bool empty() const { return !const_cast<ParBridge*>(this)->fill(); }
+
+    value_type get()
+    {
+        fill();
+        return item();
+    }
+
+    value_type next()
+    {
+        fill();
+        value_type front = std::forward<value_type>(item());
+        ++m_pos;
+        return std::forward<value_type>(front);
+    }
+
+    // a moved-from bridge has nothing left to stop
+    void stop_iteration()
+    {
+        if (m_shared) {
+            std::lock_guard<std::mutex> lock(m_shared->mutex);
+            m_shared->iter.stop_iteration();
+        }
+        m_buffer.clear();
+        m_pos = 0;
+    }
+
+    // in parts rather than elements, as the parts only take their elements once they run
+    size_t split_size() const { return m_parts; }
+
+    // the buffered elements go to the front part
+    ParBridge split_front(size_t n)
+    {
+        ParBridge front(m_shared, m_batch, std::min(n, m_parts));
+        m_parts -= front.m_parts;
+        std::swap(front.m_buffer, m_buffer);
+        std::swap(front.m_pos, m_pos);
+        return front;
+    }
+
+    // takes the next batch once the buffer is consumed, false if the upstream adapter is exhausted
+    bool fill()
+    {
+        if (m_pos != m_buffer.size()) {
+            return true;
+        }
+        m_buffer.clear();
+        m_buffer.reserve(m_batch);
+        m_pos = 0;
+        std::lock_guard<std::mutex> lock(m_shared->mutex);
+        for (auto& upstream = m_shared->iter; (m_buffer.size() < m_batch) && !upstream.empty();) {
+            m_buffer.emplace_back(std::in_place, upstream.next());
+        }
+        return !m_buffer.empty();
+    }
+
+    auto& item()
+    {
+        if constexpr (std::is_lvalue_reference_v<value_type>) {
+            return m_buffer[m_pos]->get();
+        }
+        else {
+            return *m_buffer[m_pos];
+        }
+    }
+
+    std::shared_ptr<Shared> m_shared;
+    size_t m_batch;
+    size_t m_parts;
+    std::vector<Slot> m_buffer;
+    size_t m_pos = 0;
+};
+
+/// Runs the stages before a pipeline_stage() on a thread of their own, which passes batches of elements to the
+/// consumer through a queue of at most `depth` batches. The thread starts with the first read and is joined when the
+/// stage is stopped or destroyed, so that the work upstream overlaps with the work downstream.
+template <typename T>
+class [[nodiscard]] PipelineStage final : public SourceBase<PipelineStage<T>> {
+    using Slot = Fallible<typename T::value_type>;
+    using Batch = std::vector<Slot>;
+
+    struct Channel final {
+        explicit Channel(T&& t)
+        : iter(std::move(t))
+        {
+        }
+
+        Channel(Channel const&) = delete;
+        Channel& operator=(Channel const&) = delete;
+
+        ~Channel() { cancel(); }
+
+        void cancel()
+        {
+            if (producer.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cancelled = true;
+                }
+                changed.notify_all();
+                producer.join();
+            }
+        }
+
+        T iter; // only read by the producer once it started
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Batch> full;
+        std::vector<Batch> spare; // consumed batches, reused for their capacity
+        std::exception_ptr error;
+        bool closed = false;
+        bool cancelled = false;
+        std::thread producer;
+    };
+
+public:
+    MOVE_ONLY(PipelineStage);
+
+    ALL_FRIEND;
+
+    using value_type = std::conditional_t<
+        std::is_lvalue_reference_v<typename T::value_type>,
+        typename T::value_type,
+        std::decay_t<typename T::value_type>>;
+
+    static constexpr bool exact_size = T::exact_size;
+
+    PipelineStage(T&& t, size_t batch, size_t depth)
+    : m_hint(t.size_hint())
+    , m_channel(std::make_unique<Channel>(std::move(t)))
+    , m_batch(std::max<size_t>(batch, 1))
+    , m_depth(std::max<size_t>(depth, 1))
+    {
+    }
+
+    /// the hint of the stages before it, less the elements consumed since
+    SizeHint size_hint() const
+    {
+        return {m_hint.first - std::min(m_hint.first, m_consumed),
+                m_hint.second ? std::optional<size_t>(*m_hint.second - m_consumed) : std::nullopt};
+    }
+
+private:
+    bool empty() const { return !const_cast<PipelineStage*>(this)->fill(); }
+
+    size_t distance() const { return *size_hint().second; }
+
+    value_type get()
+    {
+        fill();
+        return item();
+    }
+
+    value_type next()
+    {
+        fill();
+        value_type front = std::forward<value_type>(item());
+        ++m_pos;
+        ++m_consumed;
+        return std::forward<value_type>(front);
+    }
+
+    // the producer is joined first, after which the stages before it are only accessed from here
+    void stop_iteration()
+    {
+        if (m_channel) {
+            m_channel->cancel();
+            m_channel->iter.stop_iteration();
+            m_channel->full.clear();
+            m_channel->closed = true;
+        }
+        m_current.clear();
+        m_pos = 0;
+        m_hint = {m_consumed, m_consumed};
+    }
+
+    // takes the next batch off the queue once the current one is consumed, false once the producer has finished
+    bool fill()
+    {
+        if (m_pos != m_current.size()) {
+            return true;
+        }
+        Channel& channel = *m_channel;
+        if (!channel.producer.joinable() && !channel.closed) {
+            channel.producer = std::thread([&channel, batch = m_batch, depth = m_depth] {
+                produce(channel, batch, depth);
+            });
+        }
+        std::unique_lock<std::mutex> lock(channel.mutex);
+        if (m_current.capacity() != 0) {
+            m_current.clear();
+            channel.spare.push_back(std::move(m_current));
+        }
+        m_current = Batch();
+        m_pos = 0;
+        channel.changed.wait(lock, [&channel] { return channel.closed || !channel.full.empty(); });
+        if (channel.full.empty()) {
+            if (channel.error) {
+                std::rethrow_exception(std::exchange(channel.error, nullptr));
+            }
+            return false;
+        }
+        m_current = std::move(channel.full.front());
+        channel.full.pop_front();
+        lock.unlock();
+        channel.changed.notify_all();
+        return true;
+    }
+
+    // the elements read before an exception are still passed on, the exception is rethrown after them
+    static void produce(Channel& channel, size_t batchSize, size_t depth)
+    {
+        for (bool closed = false; !closed;) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(channel.mutex);
+                channel.changed.wait(lock, [&] { return channel.cancelled || (channel.full.size() < depth); });
+                if (channel.cancelled) {
+                    return;
+                }
+                if (!channel.spare.empty()) {
+                    batch = std::move(channel.spare.back());
+                    channel.spare.pop_back();
+                }
+            }
+            std::exception_ptr error;
+            try {
+                batch.reserve(batchSize);
+                for (auto& upstream = channel.iter; (batch.size() < batchSize) && !upstream.empty();) {
+                    batch.emplace_back(std::in_place, upstream.next());
+                }
+                closed = channel.iter.empty();
+            }
+            catch (...) {
+                error = std::current_exception();
+                closed = true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(channel.mutex);
+                if (!batch.empty()) {
+                    channel.full.push_back(std::move(batch));
+                }
+                channel.error = error;
+                channel.closed = closed;
+            }
+            channel.changed.notify_all();
+        }
+    }
+
+    auto& item()
+    {
+        if constexpr (std::is_lvalue_reference_v<value_type>) {
+            return m_current[m_pos]->get();
+        }
+        else {
+            return *m_current[m_pos];
+        }
+    }
+
+    SizeHint m_hint;
+    size_t m_consumed = 0;
+    std::unique_ptr<Channel> m_channel;
+    size_t m_batch;
+    size_t m_depth;
+    Batch m_current;
+    size_t m_pos = 0;
+};
+
+/// a line without the "\r" of a "\r\n" line ending
+template <typename CharT>
+std::basic_string_view<CharT> trim_line(CharT const* begin, CharT const* end)
+{
+    if ((end != begin) && (end[-1] == CharT('\r'))) {
+        --end;
+    }
+    return {begin, static_cast<size_t>(end - begin)};
+}
+
+#if __has_include(<sys/mman.h>)
+/// read-only mapping of a whole file
+class MappedFile final {
+public:
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    explicit MappedFile(std::string const& path)
+    {
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            int const error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat " + path);
+        }
+        m_size = static_cast<size_t>(info.st_size);
+        if (m_size != 0) {
+            void* const data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                int const error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap " + path);
+            }
+            m_data = static_cast<char const*>(data);
+        }
+        // the mapping outlives the descriptor
+        ::close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+    char const* data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+private:
+    char const* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/// a file of fixed-size records seen as a read-only container, a trailing partial record is ignored
+template <typename T>
+class MappedRecords final {
+public:
+    using value_type = T;
+    using iterator = T const*;
+    using const_iterator = T const*;
+
+    static_assert(std::is_trivially_copyable_v<T>, "Records must be trivially copyable");
+
+    explicit MappedRecords(std::string const& path)
+    : m_file(path)
+    {
+    }
+
+    T const* data() const { return reinterpret_cast<T const*>(m_file.data()); }
+
+    T const* begin() const { return data(); }
+
+    T const* end() const { return data() + (m_file.size() / sizeof(T)); }
+
+    T const* cbegin() const { return begin(); }
+
+    T const* cend() const { return end(); }
+
+private:
+    MappedFile m_file;
+};
+
+/// the lines of a memory-mapped file as views into the mapping, split at line boundaries for the parallel terminals
+class [[nodiscard]] MappedLines final : public SourceBase<MappedLines> {
+public:
+    MOVE_ONLY(MappedLines);
+
+    ALL_FRIEND;
+
+    using value_type = std::string_view;
+
+    static constexpr bool bidirectional = true;
+    static constexpr bool splittable = true;
+
+    explicit MappedLines(std::shared_ptr<MappedFile const> file)
+    : MappedLines(file->data(), file->data() + file->size(), file)
+    {
+    }
+
+    /// at most one line per byte
+    SizeHint size_hint() const { return {empty() ? 0 : 1, split_size()}; }
+
+private:
+    MappedLines(char const* begin, char const* end, std::shared_ptr<MappedFile const> file)
+    : m_begin(begin)
+    , m_end(end)
+    , m_file(std::move(file))
+    {
+    }
+
+    bool empty() const { return m_begin == m_end; }
+
+    std::string_view get() { return trim_line(m_begin, line_end()); }
+
+    std::string_view get_back() { return trim_line(line_begin_back(), back_end()); }
+
+    std::string_view next()
+    {
+        char const* const end = line_end();
+        std::string_view const line = trim_line(m_begin, end);
+        m_begin = (end == m_end) ? m_end : (end + 1);
+        m_lineEnd = nullptr;
+        return line;
+    }
+
+    std::string_view next_back()
+    {
+        char const* const begin = line_begin_back();
+        std::string_view const line = trim_line(begin, back_end());
+        m_end = begin;
+        m_lineEnd = nullptr;
+        return line;
+    }
+
+    void stop_iteration() { m_begin = m_end; }
+
+    // in bytes
+    size_t split_size() const { return static_cast<size_t>(m_end - m_begin); }
+
+    MappedLines split_front(size_t n)
+    {
+        char const* cut = m_begin + std::min(n, split_size());
+        if (cut != m_begin) {
+            std::string_view const rest(cut - 1, static_cast<size_t>(m_end - cut + 1));
+            size_t const newline = rest.find('\n');
+            cut = (newline == std::string_view::npos) ? m_end : (cut + newline);
+        }
+        MappedLines front(m_begin, cut, m_file);
+        m_begin = cut;
+        m_lineEnd = nullptr;
+        return front;
+    }
+
+    // the newline ending the front line, or the end of the file
+    char const* line_end()
+    {
+        if (m_lineEnd == nullptr) {
+            std::string_view const rest(m_begin, split_size());
+            size_t const newline = rest.find('\n');
+            m_lineEnd = (newline == std::string_view::npos) ? m_end : (m_begin + newline);
+        }
+        return m_lineEnd;
+    }
+
+    // the newline after the back line terminates it rather than starting an empty line
+    char const* back_end() const { return (m_end[-1] == '\n') ? (m_end - 1) : m_end; }
+
+    char const* line_begin_back() const
+    {
+        std::string_view const rest(m_begin, static_cast<size_t>(back_end() - m_begin));
+        size_t const newline = rest.rfind('\n');
+        return (newline == std::string_view::npos) ? m_begin : (m_begin + newline + 1);
+    }
+
+    char const* m_begin;
+    char const* m_end;
+    char const* m_lineEnd = nullptr;
+    std::shared_ptr<MappedFile const> m_file;
+};
+#endif
+
+/// the lines of a stream as views into a buffer that is refilled in chunks, so that a line stays valid only until
+/// the next line is read; lines longer than a chunk grow the buffer
+template <typename StreamT>
+class [[nodiscard]] ReadLines final : public SourceBase<ReadLines<StreamT>> {
+public:
+    MOVE_ONLY(ReadLines);
+
+    ALL_FRIEND;
+
+    using char_type = typename StreamT::char_type;
+    using value_type = std::basic_string_view<char_type>;
+
+    ReadLines(StreamT& stream, size_t chunk_size, std::pmr::memory_resource* resource)
+    : m_stream(&stream)
+    , m_chunkSize(chunk_size)
+    , m_buffer(resource)
+    {
+        assert(chunk_size != 0);
+    }
+
+    SizeHint size_hint() const { return {m_lineEnd ? 1 : 0, std::nullopt}; }
+
+private:
+    bool empty() const
+    {
+        // the stream is only read once a line is needed
+        return !const_cast<ReadLines&>(*this).fill();
+    }
+
+    value_type get()
+    {
+        fill();
+        return trim_line(m_buffer.data() + m_begin, m_buffer.data() + *m_lineEnd);
+    }
+
+    value_type next()
+    {
+        value_type const line = get();
+        m_begin = std::min(*m_lineEnd + 1, m_size);
+        m_scanned = m_begin;
+        m_lineEnd.reset();
+        return line;
+    }
+
+    void stop_iteration()
+    {
+        m_begin = m_size;
+        m_scanned = m_size;
+        m_lineEnd.reset();
+        m_exhausted = true;
+    }
+
+    bool fill()
+    {
+        while (!m_lineEnd) {
+            value_type const unread(m_buffer.data() + m_scanned, m_size - m_scanned);
+            size_t const newline = unread.find(char_type('\n'));
+            if (newline != value_type::npos) {
+                m_lineEnd = m_scanned + newline;
+            }
+            else if (m_exhausted) {
+                if (m_begin == m_size) {
+                    return false;
+                }
+                m_lineEnd = m_size;
+            }
+            else {
+                read();
+            }
+        }
+        return true;
+    }
+
+    void read()
+    {
+        // the lines before m_begin were handed out already
+        std::move(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_begin),
+                  m_buffer.begin() + static_cast<std::ptrdiff_t>(m_size),
+                  m_buffer.begin());
+        m_size -= m_begin;
+        m_scanned = m_size;
+        m_begin = 0;
+        if (m_buffer.size() < m_size + m_chunkSize) {
+            m_buffer.resize(m_size + m_chunkSize);
+        }
+        m_stream->read(m_buffer.data() + m_size, static_cast<std::streamsize>(m_chunkSize));
+        m_size += static_cast<size_t>(m_stream->gcount());
+        m_exhausted = !(*m_stream);
+    }
+
+    StreamT* m_stream;
+    size_t m_chunkSize;
+    std::pmr::vector<char_type> m_buffer;
+    size_t m_begin = 0;
+    size_t m_size = 0;
+    size_t m_scanned = 0;
+    std::optional<size_t> m_lineEnd;
+    bool m_exhausted = false;
+};
+
+class Adapter {
+protected:
+    ~Adapter() = default;
+};
+
+template <typename T, typename AdapterT>
+class [[nodiscard]] AdapterBase : public Adapter {
+public:
+    MOVE_ONLY(AdapterBase);
+
+    static constexpr bool random_access = T::random_access;
+    static constexpr bool bidirectional = T::bidirectional;
+    static constexpr bool exact_size = T::exact_size;
+    static constexpr bool splittable = T::splittable;
+    static constexpr bool indexed = false; // redeclared by adapters that support get_at()
+    static constexpr bool bridged = T::bridged; // split into the parts of a ParBridge, see par_reduce_part()
+    static constexpr bool contiguous = false; // redeclared by adapters that pass the elements through
+    static constexpr bool contiguous_source = false; // redeclared by adapters that support source() and visit()
+
+    constexpr explicit AdapterBase(T&& t)
+    : m_iter(std::move(t))
+    {
+    }
+
+    /// iterators
+    constexpr AdapterT begin() { return cbegin(); }
+
+    constexpr AdapterT begin() const { return cbegin(); }
+
+    constexpr AdapterT cbegin() const
+    {
+        auto& self = const_cast<AdapterT&>(downcast());
+        AdapterT clone = std::move(self);
+        self.stop_iteration();
+        return clone;
+    }
+
+    constexpr int end() { return 0; }
+
+    constexpr int end() const { return 0; }
+
+    constexpr int cend() const { return 0; }
+
+    /// accessors
+    constexpr AdapterBase& operator++() { return *this; }
+
+    constexpr bool operator!=(int) const { return !downcast().empty(); }
+
+    /// bounds on the number of remaining elements
+    constexpr SizeHint size_hint() const { return m_iter.size_hint(); }
+
+    /// adapters
+    template <typename FnT>
+    [[nodiscard]] constexpr bool all(FnT const& fn)
+    {
+        return any_or_all(fn, false);
+    }
+
+    template <typename FnT>
+    [[nodiscard]] constexpr bool any(FnT const& fn)
+    {
+        return any_or_all(fn, true);
+    }
+
+#if defined(__cpp_lib_ranges)
+    /// a std::ranges::view of the elements, see RangeView
+    RangeView<AdapterT> as_range() { return RangeView<AdapterT>(std::move(downcast())); }
+#endif
+
+    template <typename U>
+    constexpr Chain<AdapterT, U> chain(U&& u)
+    {
+        return Chain<AdapterT, U>(std::move(downcast()), std::forward<U>(u));
+    }
+
+    /// the batches of non-contiguous elements are gathered in buffers allocated from the memory resource
+    Chunks<AdapterT, false> chunks(size_t n, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        return Chunks<AdapterT, false>(std::move(downcast()), n, resource);
+    }
+
+    Chunks<AdapterT, true> chunks_exact(
+        size_t n, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        return Chunks<AdapterT, true>(std::move(downcast()), n, resource);
+    }
+
+    /// std::arrays are filled from the front, up to their size
+    template <typename ContainerT>
+    [[nodiscard]] constexpr ContainerT collect()
+    {
+        if constexpr (IsStdArrayV<ContainerT>) {
+            ContainerT array{};
+            if (array.size() != 0) {
+                size_t i = 0;
+                downcast().try_fold(i, [&array](size_t& n, auto&& item) {
+                    array[n] = std::forward<decltype(item)>(item);
+                    return ++n != array.size();
+                });
+            }
+            return array;
+        }
+        else {
+            return downcast().collect_into(ContainerT{});
+        }
+    }
+
+    /// the container is constructed from the allocator (or memory resource), so that its storage comes from there
+    template <typename ContainerT, typename AllocT>
+    [[nodiscard]] constexpr ContainerT collect(AllocT const& alloc)
+    {
+        return downcast().collect_into(ContainerT(alloc));
+    }
+
+    /// collects into a std::vector using the allocator, memory resources yield a std::pmr::vector
+    template <typename AllocT>
+    [[nodiscard]] auto collect_in(AllocT const& alloc)
+    {
+        using ElementT = std::decay_t<typename AdapterT::value_type>;
+        return collect<std::vector<ElementT, AllocatorForT<AllocT, ElementT>>>(alloc);
+    }
+
+    [[nodiscard]] constexpr size_t count()
+    {
+        auto& self = downcast();
+        if constexpr (AdapterT::exact_size) {
+            size_t const n = self.distance();
+            self.stop_iteration();
+            return n;
+        }
+        else {
+            size_t i = 0;
+            self.try_fold(i, [](size_t& n, auto&&) {
+                ++n;
+                return true;
+            });
+            return i;
+        }
+    }
+
+    template <typename FnT>
+    [[nodiscard]] constexpr size_t count_if(FnT const& fn)
+    {
+        return downcast().accumulate(
+            size_t{0}, [&fn](size_t& n, auto&& item) { n += static_cast<bool>(fn(item)); }, std::plus<size_t>{});
+    }
+
+    /// the number of elements per key, in a std::unordered_map (or MapT) reserved for size_hint() keys
+    template <typename MapT = void, typename FnT>
+    [[nodiscard]] auto counts_by(FnT const& fn) /* -> std::unordered_map<key, size_t> */
+    {
+        using KeyT = KeyOfT<FnT, typename AdapterT::value_type>;
+        using ResultT = OrDefaultT<MapT, std::unordered_map<KeyT, size_t>>;
+        ResultT counts;
+        reserve_table(counts);
+        downcast().try_fold(counts, [&fn](ResultT& c, auto&& item) {
+            ++c[fn(std::as_const(item))];
+            return true;
+        });
+        return counts;
+    }
+
+    /// only the first of each run of equal elements
+    constexpr Dedup<AdapterT> dedup() { return Dedup<AdapterT>(std::move(downcast())); }
+
+    constexpr Enumerate<AdapterT> enumerate() { return Enumerate<AdapterT>(std::move(downcast())); }
+
+    /// adjacent filters are fused into one with both predicates
+    template <typename FnT>
+    constexpr auto filter(FnT&& fn) /* -> Filter */
+    {
+        if constexpr (IsSpecializationV<AdapterT, Filter>) {
+            using FirstT = decltype(downcast().m_predicate);
+            using PredicateT = Conjoined<FirstT, FnT>;
+            return Filter<T, PredicateT>(
+                std::move(m_iter), PredicateT{std::forward<FirstT>(downcast().m_predicate), std::forward<FnT>(fn)});
+        }
+        else {
+            return Filter<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+        }
+    }
+
+    /// the adapter stops at the element found without advancing past it, like nth(); an element yielded as an rvalue
+    /// is moved into the result
+    template <typename FnT>
+    [[nodiscard]] constexpr auto find(FnT const& fn) /* -> std::optional<value_type> */
+    {
+        advance_while(fn, false);
+        return fallible_deref();
+    }
+
+    /// the elements of each adapter or container returned by fn, see flatten()
+    template <typename FnT>
+    auto flat_map(FnT&& fn) /* -> Flatten */
+    {
+        auto mapped = map(std::forward<FnT>(fn));
+        return Flatten<decltype(mapped)>(std::move(mapped));
+    }
+
+    /// the elements of each element in turn, which must be adapters or containers; containers are borrowed when they
+    /// are referenced (and moved from for rvalue references), and kept until the next one when they are values
+    Flatten<AdapterT> flatten() { return Flatten<AdapterT>(std::move(downcast())); }
+
+    /// the accumulator is moved into every call of fn, unless fn takes it by lvalue reference
+    template <typename InitT, typename FnT>
+    [[nodiscard]] constexpr InitT fold(InitT init, FnT const& fn)
+    {
+        downcast().try_fold(init, [&fn](InitT& acc, auto&& item) {
+            if constexpr (std::is_invocable_v<FnT const&, InitT&&, decltype(item)>) {
+                acc = fn(std::move(acc), std::forward<decltype(item)>(item));
+            }
+            else {
+                acc = fn(acc, std::forward<decltype(item)>(item));
+            }
+            return true;
+        });
+        return init;
+    }
+
+    template <typename FnT>
+    constexpr void for_each(FnT const& fn)
+    {
+        downcast().try_fold(fn, [](FnT const& f, auto&& item) {
+            f(std::forward<decltype(item)>(item));
+            return true;
+        });
+    }
+
+#if defined(__cpp_lib_coroutine)
+    /// for_each() on a thread of the scheduler, the caller goes on until it awaits the Completion; the adapter is
+    /// destroyed on that thread before the Completion is. The job blocks while a from_async() source waits, so that
+    /// source needs a different scheduler, or one with threads to spare.
+    template <typename SchedulerT, typename FnT>
+    Completion for_each_async(SchedulerT& scheduler, FnT&& fn)
+    {
+        static_assert(IsSchedulerV<SchedulerT>, "Scheduler required");
+        using Job = std::pair<AdapterT, std::decay_t<FnT>>;
+        auto state = std::make_shared<Completion::State>();
+        // shared, since schedulers may require copyable callables
+        auto job = std::make_shared<Job>(std::move(downcast()), std::forward<FnT>(fn));
+        scheduler.post([job, state] {
+            std::exception_ptr error;
+            try {
+                AdapterT adapter(std::move(job->first));
+                adapter.for_each(job->second);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            state->complete(error);
+        });
+        return Completion(std::move(state));
+    }
+#endif
+
+    /// the elements per key in their order, in a std::unordered_map of std::vectors (or MapT) reserved for
+    /// size_hint() keys
+    template <typename MapT = void, typename FnT>
+    [[nodiscard]] auto group_by(FnT const& fn) /* -> std::unordered_map<key, std::vector<value_type>> */
+    {
+        using ElementT = std::decay_t<typename AdapterT::value_type>;
+        using KeyT = KeyOfT<FnT, ElementT>;
+        using ResultT = OrDefaultT<MapT, std::unordered_map<KeyT, std::vector<ElementT>>>;
+        using GroupT = typename ResultT::mapped_type;
+        ResultT groups;
+        reserve_table(groups);
+        downcast().try_fold(groups, [&fn](ResultT& g, auto&& item) {
+            Emplacer<GroupT>::emplace(g[fn(std::as_const(item))], std::forward<decltype(item)>(item));
+            return true;
+        });
+        return groups;
+    }
+
+    template <typename FnT>
+    constexpr Inspect<AdapterT, FnT> inspect(FnT&& fn)
+    {
+        return Inspect<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+    }
+
+    [[nodiscard]] constexpr auto last() /* -> std::optional<value_type> */
+    {
+        auto& self = downcast();
+        if constexpr (AdapterT::exact_size) {
+            size_t const n = self.distance();
+            if (n > 1) {
+                self.advance_by(n - 1);
+            }
+            return fallible_deref();
+        }
+        else {
+            Fallible<decltype(self.next())> result;
+            self.try_fold(result, [](auto& found, auto&& item) {
+                found.emplace(std::forward<decltype(item)>(item));
+                return true;
+            });
+            return result;
+        }
+    }
+
+    /// buffers up to N elements ahead in inline storage, so that they can be inspected with peek() before they are
+    /// consumed; each element is still computed once
+    template <size_t N>
+    constexpr Lookahead<AdapterT, N> lookahead()
+    {
+        return Lookahead<AdapterT, N>(std::move(downcast()));
+    }
+
+    /// adjacent maps are fused into one that applies the functions in turn
+    template <typename FnT>
+    constexpr auto map(FnT&& fn) /* -> Map */
+    {
+        if constexpr (IsSpecializationV<AdapterT, Map>) {
+            using FirstT = decltype(downcast().m_f);
+            using ComposedT = Composed<FirstT, FnT>;
+            return Map<T, ComposedT>(
+                std::move(m_iter), ComposedT{std::forward<FirstT>(downcast().m_f), std::forward<FnT>(fn)});
+        }
+        else {
+            return Map<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+        }
+    }
+
+    template <typename FnT>
+    constexpr MapCached<AdapterT, FnT> map_cached(FnT&& fn)
+    {
+        return MapCached<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+    }
+
+    /// the values of the std::optionals returned by fn, up to the first std::nullopt
+    template <typename FnT>
+    constexpr MapWhile<AdapterT, FnT> map_while(FnT&& fn)
+    {
+        return MapWhile<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+    }
+
+    [[nodiscard]] constexpr auto max() /* -> std::optional<value_type> */ { return min_or_max(std::greater<>{}); }
+
+    /// set operations and merges of two adapters sorted by compare, with the semantics of std::merge() and
+    /// std::set_union() etc: equal elements are matched one to one, and those of this adapter come first
+    template <typename U, typename CompareT = std::less<>>
+    constexpr Merge<AdapterT, U, CompareT, MergeOp::Merge> merge(U&& u, CompareT&& compare = CompareT{})
+    {
+        return merge_with<MergeOp::Merge>(std::forward<U>(u), std::forward<CompareT>(compare));
+    }
+
+    /// the element with the largest fn(element), fn is called once per element
+    template <typename FnT>
+    [[nodiscard]] constexpr auto max_by_key(FnT const& fn) /* -> std::optional<value_type> */
+    {
+        return min_or_max_by_key(fn, std::greater<>{});
+    }
+
+    [[nodiscard]] constexpr auto min() /* -> std::optional<value_type> */ { return min_or_max(std::less<>{}); }
+
+    template <typename FnT>
+    [[nodiscard]] constexpr auto min_by_key(FnT const& fn) /* -> std::optional<value_type> */
+    {
+        return min_or_max_by_key(fn, std::less<>{});
+    }
+
+    [[nodiscard]] constexpr auto nth(size_t n) /* -> std::optional<value_type> */
+    {
+        downcast().advance_by(n);
+        return fallible_deref();
+    }
+
+    /// hands the elements out to the parts of the parallel terminals in batches and in no particular order, so that
+    /// chains over sequential sources, such as lists or streams, keep every thread busy
+    Iterator<ParBridge<AdapterT>> par_bridge(size_t batch = 64)
+    {
+        return Iterator<ParBridge<AdapterT>>(ParBridge<AdapterT>(std::move(downcast()), batch));
+    }
+
+    /// parallel terminals: chains over random-access sources are split recursively and the parts are run on the
+    /// executor (see with_executor()), the functors are invoked concurrently and the results are merged in order
+    template <typename ContainerT>
+    [[nodiscard]] ContainerT par_collect()
+    {
+        return par_reduce(
+            [](AdapterT&& part) { return part.template collect<ContainerT>(); },
+            [](ContainerT&& lhs, ContainerT&& rhs) {
+                Emplacer<ContainerT>::append(lhs, std::move(rhs));
+                return std::move(lhs);
+            });
+    }
+
+    [[nodiscard]] size_t par_count()
+    {
+        return par_reduce([](AdapterT&& part) { return part.count(); }, std::plus<size_t>{});
+    }
+
+    /// counts_by() into a table per part, the tables are merged afterwards
+    template <typename MapT = void, typename FnT>
+    [[nodiscard]] auto par_counts_by(FnT const& fn) /* -> std::unordered_map<key, size_t> */
+    {
+        using ResultT = decltype(counts_by<MapT>(fn));
+        return par_reduce(
+            [&fn](AdapterT&& part) { return part.template counts_by<MapT>(fn); },
+            [](ResultT&& lhs, ResultT&& rhs) {
+                merge_tables(lhs, std::move(rhs), [](auto& count, auto other) { count += other; });
+                return std::move(lhs);
+            });
+    }
+
+    template <typename InitT, typename FnT, typename CombineT>
+    [[nodiscard]] InitT par_fold(InitT const& init, FnT const& fn, CombineT const& combine)
+    {
+        return par_reduce([&init, &fn](AdapterT&& part) { return part.fold(init, fn); }, combine);
+    }
+
+    template <typename FnT>
+    void par_for_each(FnT const& fn)
+    {
+        par_reduce(
+            [&fn](AdapterT&& part) {
+                part.for_each(fn);
+                return true;
+            },
+            std::logical_and<bool>{});
+    }
+
+    /// group_by() into a table per part, the groups of later parts are appended to those of earlier parts
+    template <typename MapT = void, typename FnT>
+    [[nodiscard]] auto par_group_by(FnT const& fn) /* -> std::unordered_map<key, std::vector<value_type>> */
+    {
+        using ResultT = decltype(group_by<MapT>(fn));
+        using GroupT = typename ResultT::mapped_type;
+        return par_reduce(
+            [&fn](AdapterT&& part) { return part.template group_by<MapT>(fn); },
+            [](ResultT&& lhs, ResultT&& rhs) {
+                merge_tables(lhs, std::move(rhs), [](GroupT& group, GroupT&& other) {
+                    Emplacer<GroupT>::append(group, std::move(other));
+                });
+                return std::move(lhs);
+            });
+    }
+
+    template <typename RetT, typename FnT>
+    [[nodiscard]] constexpr std::pair<RetT /* trues */, RetT /* falses */> partition(FnT const& fn)
+    {
+        return partition_into(std::pair<RetT, RetT>(), fn);
+    }
+
+    template <typename RetT, typename FnT, typename AllocT>
+    [[nodiscard]] constexpr std::pair<RetT /* trues */, RetT /* falses */> partition(FnT const& fn, AllocT const& alloc)
+    {
+        return partition_into(std::pair<RetT, RetT>(RetT(alloc), RetT(alloc)), fn);
+    }
+
+    constexpr Lookahead<AdapterT, 1> peekable() { return Lookahead<AdapterT, 1>(std::move(downcast())); }
+
+    /// runs the stages so far on a thread of their own, which passes their elements on in batches through a queue
+    Iterator<PipelineStage<AdapterT>> pipeline_stage(size_t batch = 256, size_t depth = 4)
+    {
+        return Iterator<PipelineStage<AdapterT>>(PipelineStage<AdapterT>(std::move(downcast()), batch, depth));
+    }
+
+    /// partitions into two std::vectors using the allocator, memory resources yield std::pmr::vectors
+    template <typename FnT, typename AllocT>
+    [[nodiscard]] auto partition_in(FnT const& fn, AllocT const& alloc)
+    {
+        using ElementT = std::decay_t<typename AdapterT::value_type>;
+        return partition<std::vector<ElementT, AllocatorForT<AllocT, ElementT>>>(fn, alloc);
+    }
+
+    /// the adapter stops at the element found without advancing past it, like find()
+    template <typename FnT>
+    [[nodiscard]] constexpr std::optional<size_t> position(FnT const& fn)
+    {
+        size_t const num_steps = advance_while(fn, false);
+        return downcast().empty() ? std::nullopt : std::optional<size_t>(num_steps);
+    }
+
+    [[nodiscard]] constexpr auto product() /* -> value_type */
+    {
+        using ElementT = std::decay_t<decltype(downcast().next())>;
+        using AccT = AccumulatorT<ElementT>;
+        return static_cast<ElementT>(downcast().accumulate(
+            AccT{1}, [](AccT& acc, auto&& item) { acc = acc * static_cast<AccT>(item); }, std::multiplies<AccT>{}));
+    }
+
+    /// profile() stages report to ProfileCounters::global() or to the sink, a callable taking a ProfileRecord;
+    /// unless Enabled (see ITERATOR_ADAPTERS_PROFILE), the adapter is returned as is
+    template <bool Enabled = ProfilingV>
+    auto profile(std::string_view name)
+    {
+        return profile<Enabled>(name, std::ref(ProfileCounters::global()));
+    }
+
+    template <bool Enabled = ProfilingV, typename SinkT>
+    auto profile([[maybe_unused]] std::string_view name, [[maybe_unused]] SinkT&& sink)
+    {
+        if constexpr (Enabled) {
+            using Stage = Profile<AdapterT, std::decay_t<SinkT>>;
+            return Stage(std::move(downcast()), std::string(name), std::decay_t<SinkT>(std::forward<SinkT>(sink)));
+        }
+        else {
+            return AdapterT(std::move(downcast()));
+        }
+    }
+
+    constexpr Reverse<AdapterT> reverse() { return Reverse<AdapterT>(std::move(downcast())); }
+
+    /// the results of fn(state, element) with a state that starts from init, up to the first std::nullopt if fn
+    /// returns std::optionals
+    template <typename StateT, typename FnT>
+    constexpr auto scan(StateT init, FnT&& fn) /* -> MapWhile */
+    {
+        return map_while([state = std::move(init), f = std::forward<FnT>(fn)](auto&& item) mutable {
+            using ResultT = std::invoke_result_t<FnT&, StateT&, decltype(item)>;
+            if constexpr (IsOptionalV<ResultT>) {
+                return f(state, std::forward<decltype(item)>(item));
+            }
+            else {
+                return std::optional<ResultT>(f(state, std::forward<decltype(item)>(item)));
+            }
+        });
+    }
+
+    /// skips are applied right away, adjacent ones leave a single stage
+    constexpr auto skip(size_t n) /* -> Skip */
+    {
+        if constexpr (IsSpecializationV<AdapterT, Skip>) {
+            return Skip<T>(std::move(m_iter), n);
+        }
+        else {
+            return Skip<AdapterT>(std::move(downcast()), n);
+        }
+    }
+
+    /// the elements after the leading ones that match fn
+    template <typename FnT>
+    constexpr SkipWhile<AdapterT, FnT> skip_while(FnT&& fn)
+    {
+        return SkipWhile<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+    }
+
+    template <typename U, typename CompareT = std::less<>>
+    constexpr Merge<AdapterT, U, CompareT, MergeOp::Difference> set_difference(U&& u, CompareT&& compare = CompareT{})
+    {
+        return merge_with<MergeOp::Difference>(std::forward<U>(u), std::forward<CompareT>(compare));
+    }
+
+    template <typename U, typename CompareT = std::less<>>
+    constexpr Merge<AdapterT, U, CompareT, MergeOp::Intersection> set_intersection(
+        U&& u, CompareT&& compare = CompareT{})
+    {
+        return merge_with<MergeOp::Intersection>(std::forward<U>(u), std::forward<CompareT>(compare));
+    }
+
+    template <typename U, typename CompareT = std::less<>>
+    constexpr Merge<AdapterT, U, CompareT, MergeOp::Union> set_union(U&& u, CompareT&& compare = CompareT{})
+    {
+        return merge_with<MergeOp::Union>(std::forward<U>(u), std::forward<CompareT>(compare));
+    }
+
+    /// the elements are buffered in memory allocated from the resource once the first one is needed, followed by
+    /// take(n) only n of them are kept at a time
+    template <typename CompareT = std::less<>>
+    Sorted<AdapterT, CompareT> sorted(
+        CompareT&& compare = CompareT{}, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        return Sorted<AdapterT, CompareT>(std::move(downcast()), std::forward<CompareT>(compare), resource);
+    }
+
+    constexpr StepBy<AdapterT> step_by(size_t step) { return StepBy<AdapterT>(std::move(downcast()), step); }
+
+    [[nodiscard]] constexpr auto sum() /* -> value_type */
+    {
+        using ElementT = std::decay_t<decltype(downcast().next())>;
+        using AccT = AccumulatorT<ElementT>;
+        return static_cast<ElementT>(downcast().accumulate(
+            AccT{}, [](AccT& acc, auto&& item) { acc = acc + static_cast<AccT>(item); }, std::plus<AccT>{}));
+    }
+
+    /// adjacent takes are fused into one with the smaller count
+    constexpr auto take(size_t n) /* -> Take */
+    {
+        if constexpr (IsSpecializationV<AdapterT, Take>) {
+            return Take<T>(std::move(m_iter), std::min(downcast().m_n, n));
+        }
+        else {
+            return Take<AdapterT>(std::move(downcast()), n);
+        }
+    }
+
+    /// the leading elements that match fn, the upstream is not iterated beyond the first one that does not
+    template <typename FnT>
+    constexpr TakeWhile<AdapterT, FnT> take_while(FnT&& fn)
+    {
+        return TakeWhile<AdapterT, FnT>(std::move(downcast()), std::forward<FnT>(fn));
+    }
+
+    /// the elements not seen before, a copy of each is kept in a std::unordered_set (or SetT) reserved for size_hint()
+    /// elements
+    template <typename SetT = void>
+    auto unique() /* -> Unique<AdapterT, std::unordered_set<value_type>> */
+    {
+        using ElementT = std::decay_t<typename AdapterT::value_type>;
+        return Unique<AdapterT, OrDefaultT<SetT, std::unordered_set<ElementT>>>(std::move(downcast()));
+    }
+
+    /// the first k elements in the order of compare (the k largest by default), only k elements are kept at a time
+    template <typename CompareT = std::greater<>>
+    [[nodiscard]] auto top_k(size_t k, CompareT const& compare = CompareT{}) /* -> std::vector<value_type> */
+    {
+        using ElementT = std::decay_t<typename AdapterT::value_type>;
+        std::vector<ElementT> heap;
+        heap.reserve(std::min(k, downcast().size_hint().first));
+        downcast().try_fold(heap, [k, &compare](std::vector<ElementT>& h, auto&& item) {
+            push_bounded(h, k, compare, std::forward<decltype(item)>(item));
+            return true;
+        });
+        std::sort_heap(heap.begin(), heap.end(), compare);
+        return heap;
+    }
+
+    template <typename ExecT>
+    WithExecutor<AdapterT, ExecT> with_executor(ExecT& executor, size_t grain = 1)
+    {
+        return WithExecutor<AdapterT, ExecT>(std::move(downcast()), executor, grain);
+    }
+
+    Windows<AdapterT> windows(size_t n, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    {
+        return Windows<AdapterT>(std::move(downcast()), n, resource);
+    }
+
+    template <typename U>
+    constexpr Zip<AdapterT, U> zip(U&& u)
+    {
+        return Zip<AdapterT, U>(std::move(downcast()), std::forward<U>(u));
+    }
+
+protected:
+    ~AdapterBase() = default;
+
+    /* virtual */ constexpr typename T::value_type get() { return this->m_iter.get(); }
+
+    /* virtual */ constexpr typename T::value_type get_back() { return this->m_iter.get_back(); }
+
+    /* virtual */ constexpr typename T::value_type next() { return this->m_iter.next(); }
+
+    /* virtual */ constexpr typename T::value_type next_back() { return this->m_iter.next_back(); }
+
+    /* virtual */ constexpr bool empty() const { return m_iter.empty(); }
+
+    /* virtual */ constexpr void stop_iteration() { m_iter.stop_iteration(); }
+
+    /* virtual */ constexpr size_t distance() const { return m_iter.distance(); }
+
+    /* virtual */ constexpr size_t split_size() const { return m_iter.split_size(); }
+
+    /* virtual */ constexpr auto data() const { return m_iter.data(); }
+
+    // the contiguous elements (or the rows of zip_all()) underneath a chain of map() and filter(), visit() passes one
+    // of them through the chain
+    /* virtual */ constexpr auto source() const { return m_iter.source(); }
+
+    template <typename U, typename SinkT>
+    /* virtual */ constexpr void visit(U&& item, SinkT&& sink)
+    {
+        m_iter.visit(std::forward<U>(item), sink);
+    }
+
+    /* virtual */ auto execution() const { return m_iter.execution(); }
+
+    // chains of map() and filter() over contiguous elements are folded in lanes at run time, the order in which the
+    // elements are combined differs from fold(), which only matters for floating point; init must be neutral to combine
+    template <typename AccT, typename FnT, typename CombineT>
+    /* virtual */ constexpr AccT accumulate(AccT init, FnT const& fn, CombineT const& combine)
+    {
+        auto& self = downcast();
+        if constexpr (AdapterT::contiguous_source && std::is_arithmetic_v<AccT>) {
+            if (!is_constant_evaluated()) {
+                auto const source = self.source();
+                auto const data = source.data();
+                AccT const result = lanes_fold(
+                    source.size(),
+                    init,
+                    [&self, &fn, data](AccT& acc, size_t i) {
+                        self.visit(data[i], [&acc, &fn](auto&& item) { fn(acc, std::forward<decltype(item)>(item)); });
+                    },
+                    combine);
+                self.stop_iteration();
+                return result;
+            }
+        }
+        self.try_fold(init, [&fn](AccT& acc, auto&& item) {
+            fn(acc, std::forward<decltype(item)>(item));
+            return true;
+        });
+        return init;
+    }
+
+    template <typename ContainerT>
+    /* virtual */ constexpr ContainerT collect_into(ContainerT&& container)
+    {
+        Emplacer<ContainerT>::reserve(container, downcast().size_hint().first);
+        downcast().try_fold(container, [](ContainerT& c, auto&& item) {
+            Emplacer<ContainerT>::emplace(c, std::forward<decltype(item)>(item));
+            return true;
+        });
+        return std::move(container);
+    }
+
+    // at most the first n elements are going to be consumed, from either end
+    /* virtual */ constexpr void bound_to(size_t) {}
+
+    // the counters of the nearest profile() stage upstream
+    /* virtual */ ProfileStats const* profile_stats() const { return m_iter.profile_stats(); }
+
+    /* virtual */ constexpr size_t advance_by(size_t n)
+    {
+        size_t num_steps = 0;
+        auto& self = downcast();
+        while ((!self.empty()) && (num_steps < n)) {
+            self.next();
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    /* virtual */ constexpr size_t advance_back_by(size_t n)
+    {
+        size_t num_steps = 0;
+        auto& self = downcast();
+        while ((!self.empty()) && (num_steps < n)) {
+            self.next_back();
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    template <typename AccT, typename FnT>
+    /* virtual */ constexpr bool try_fold(AccT& acc, FnT&& fn)
+    {
+        for (auto& self = downcast(); !self.empty();) {
+            if (!fn(acc, self.next())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT>
+    /* virtual */ constexpr bool try_rfold(AccT& acc, FnT&& fn)
+    {
+        for (auto& self = downcast(); !self.empty();) {
+            if (!fn(acc, self.next_back())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the predicates see an lvalue, an element that get() yields as an rvalue reference must not be moved out of
+    template <typename FnT>
+    constexpr size_t advance_while(FnT const& fn, bool expected)
+    {
+        size_t num_steps = 0;
+        auto& self = downcast();
+        while (!self.empty()) {
+            auto&& item = self.get();
+            if (fn(item) != expected) {
+                break;
+            }
+            self.advance_by(1);
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    template <typename FnT>
+    constexpr size_t advance_back_while(FnT const& fn, bool expected)
+    {
+        size_t num_steps = 0;
+        auto& self = downcast();
+        while (!self.empty()) {
+            auto&& item = self.get_back();
+            if (fn(item) != expected) {
+                break;
+            }
+            self.advance_back_by(1);
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    T m_iter;
+
+private:
+    template <typename FnT>
+    constexpr bool any_or_all(FnT const& fn, bool b)
+    {
+        bool const exhausted = downcast().try_fold(b, [&fn](bool expected, auto&& item) {
+            return static_cast<bool>(fn(std::forward<decltype(item)>(item))) != expected;
+        });
+        return exhausted ? !b : b;
+    }
+
+    template <typename RetT, typename FnT>
+    constexpr std::pair<RetT, RetT> partition_into(std::pair<RetT, RetT>&& pair, FnT const& fn)
+    {
+        downcast().try_fold(pair, [&fn](std::pair<RetT, RetT>& halves, auto&& item) {
+            if (fn(item)) {
+                Emplacer<RetT>::emplace(halves.first, std::forward<decltype(item)>(item));
+            }
+            else {
+                Emplacer<RetT>::emplace(halves.second, std::forward<decltype(item)>(item));
+            }
+            return true;
+        });
+        return std::move(pair);
+    }
+
+    template <typename CompareT>
+    constexpr auto min_or_max(CompareT const& compare) /* -> std::optional<value_type> */
+    {
+        using ElementT = std::decay_t<decltype(downcast().next())>;
+        if constexpr (AdapterT::contiguous_source && std::is_arithmetic_v<ElementT>) {
+            using Limits = std::numeric_limits<ElementT>;
+            ElementT const highest = Limits::has_infinity ? Limits::infinity() : Limits::max();
+            ElementT const lowest = Limits::has_infinity ? -Limits::infinity() : Limits::lowest();
+            bool found = false;
+            ElementT const result = accumulate(
+                compare(lowest, highest) ? highest : lowest,
+                [&found, &compare](ElementT& best, auto&& item) {
+                    found = true;
+                    best = compare(item, best) ? static_cast<ElementT>(item) : best;
+                },
+                [&compare](ElementT lhs, ElementT rhs) { return compare(rhs, lhs) ? rhs : lhs; });
+            return found ? std::optional<ElementT>(result) : std::nullopt;
+        }
+        else {
+            std::optional<ElementT> result;
+            downcast().try_fold(result, [&compare](std::optional<ElementT>& best, auto&& item) {
+                if ((!best) || compare(item, *best)) {
+                    best.emplace(std::forward<decltype(item)>(item));
+                }
+                return true;
+            });
+            return result;
+        }
+    }
+
+    // sized for the case that every element has its own key, up to MaxReservedKeys of them
+    template <typename TableT>
+    void reserve_table(TableT& table) const
+    {
+        if constexpr (Reservable<TableT>) {
+            table.reserve(std::min(downcast().size_hint().first, MaxReservedKeys));
+        }
+    }
+
+    template <MergeOp Op, typename U, typename CompareT>
+    constexpr Merge<AdapterT, U, CompareT, Op> merge_with(U&& u, CompareT&& compare)
+    {
+        using ResultT = Merge<AdapterT, U, CompareT, Op>;
+        return ResultT(std::move(downcast()), std::forward<U>(u), std::forward<CompareT>(compare));
+    }
+
+    template <typename FnT, typename CompareT>
+    constexpr auto min_or_max_by_key(FnT const& fn, CompareT const& compare) /* -> std::optional<value_type> */
+    {
+        using ElementT = std::decay_t<decltype(downcast().next())>;
+        using KeyT = std::decay_t<std::invoke_result_t<FnT const&, ElementT const&>>;
+        std::optional<std::pair<KeyT, ElementT>> result;
+        downcast().try_fold(result, [&fn, &compare](std::optional<std::pair<KeyT, ElementT>>& best, auto&& item) {
+            KeyT key = fn(std::as_const(item));
+            if ((!best) || compare(key, best->first)) {
+                best.emplace(std::move(key), std::forward<decltype(item)>(item));
+            }
+            return true;
+        });
+        return result ? std::optional<ElementT>(std::move(result->second)) : std::nullopt;
+    }
+
+    template <typename LeafFnT, typename CombineT>
+    auto par_reduce(LeafFnT const& leaf, CombineT const& combine)
+    {
+        auto& self = downcast();
+        if constexpr (!AdapterT::splittable) {
+            return leaf(std::move(self));
+        }
+        else {
+            auto const execution = self.execution();
+            size_t const splits = execution.executor->concurrency();
+            AdapterT all = self.split_front(self.split_size());
+            if (splits <= 1) {
+                return leaf(std::move(all));
+            }
+            return par_reduce_part(execution, splits, std::this_thread::get_id(), std::move(all), leaf, combine);
+        }
+    }
+
+    // halves are split off until `splits` is exhausted, a part that migrated to another thread was stolen by an
+    // idle worker, which means the work is unbalanced and that part is split further
+    template <typename ExecT, typename LeafFnT, typename CombineT>
+    static auto par_reduce_part(
+        Execution<ExecT> const& execution,
+        size_t splits,
+        std::thread::id origin,
+        AdapterT&& part,
+        LeafFnT const& leaf,
+        CombineT const& combine) -> std::invoke_result_t<LeafFnT const&, AdapterT&&>
+    {
+        size_t const n = part.split_size();
+        if (std::this_thread::get_id() != origin) {
+            splits = std::max(execution.executor->concurrency(), splits / 2);
+        }
+        else if (splits > 0) {
+            splits /= 2;
+        }
+        else {
+            return leaf(std::move(part));
+        }
+        // the split size of a bridge counts its parts, which take batches of elements as they go, so the grain in
+        // elements does not apply to it
+        size_t const grain = AdapterT::bridged ? 1 : std::max<size_t>(execution.grain, 1);
+        if ((n / 2) < grain) {
+            return leaf(std::move(part));
+        }
+
+        AdapterT front = part.split_front(n / 2);
+        std::optional<std::invoke_result_t<LeafFnT const&, AdapterT&&>> lhs;
+        std::optional<std::invoke_result_t<LeafFnT const&, AdapterT&&>> rhs;
+        auto const here = std::this_thread::get_id();
+        execution.executor->join(
+            [&] { lhs.emplace(par_reduce_part(execution, splits, here, std::move(front), leaf, combine)); },
+            [&] { rhs.emplace(par_reduce_part(execution, splits, here, std::move(part), leaf, combine)); });
+        return combine(std::move(*lhs), std::move(*rhs));
+    }
+
+    constexpr auto fallible_deref() /* -> std::optional<value_type> */
+    {
+        using return_type = Fallible<decltype(downcast().next())>;
+        return (downcast().empty()) ? return_type{} : return_type{downcast().get()};
+    }
+
+    constexpr AdapterT& downcast() { return const_cast<AdapterT&>(std::as_const(*this).downcast()); }
+
+    constexpr AdapterT const& downcast() const { return *static_cast<AdapterT const*>(this); }
+};
+
+template <typename T>
+class [[nodiscard]] Iterator final : public AdapterBase<T, Iterator<T>> {
+public:
+    MOVE_ONLY(Iterator);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool indexed = T::indexed;
+    static constexpr bool contiguous = T::contiguous;
+    static constexpr bool contiguous_source = T::contiguous_source;
+
+    constexpr explicit Iterator(T&& t)
+    : AdapterBase<T, Iterator<T>>(std::move(t))
+    {
+    }
+
+    constexpr value_type operator*() { return this->m_iter.next(); }
+
+private:
+    constexpr Iterator split_front(size_t n) { return Iterator(this->m_iter.split_front(n)); }
+
+    constexpr value_type get_at(size_t n) /* override */ { return this->m_iter.get_at(n); }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return this->m_iter.advance_by(n); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, fn);
+    }
+};
+
+template <typename T, typename U>
+class [[nodiscard]] Chain final : public AdapterBase<T, Chain<T, U>> {
+public:
+    MOVE_ONLY(Chain);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = T::random_access && U::random_access;
+    static constexpr bool bidirectional = T::bidirectional && U::bidirectional;
+    static constexpr bool exact_size = T::exact_size && U::exact_size;
+    static constexpr bool splittable = T::splittable && U::splittable;
+    static constexpr bool indexed = T::indexed && U::indexed && T::exact_size;
+    static constexpr bool bridged = T::bridged || U::bridged;
+
+    static_assert(std::is_base_of_v<Adapter, U>, "Adapter required");
+    static_assert(
+        std::is_same_v<typename T::value_type, typename U::value_type>, "Chained adapter must return the same value type");
+
+    constexpr explicit Chain(T&& t, U&& u)
+    : AdapterBase<T, Chain<T, U>>(std::move(t))
+    , m_chainedIter(std::move(u))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        auto const [chainedLower, chainedUpper] = m_chainedIter.size_hint();
+        size_t const sum = lower + chainedLower;
+        SizeHint hint{(sum < lower) ? static_cast<size_t>(-1) : sum, std::nullopt};
+        if (upper && chainedUpper && (*upper + *chainedUpper >= *upper)) {
+            hint.second = *upper + *chainedUpper;
+        }
+        return hint;
+    }
+
+private:
+    constexpr bool empty() const /* override */ { return first_empty() && second_empty(); }
+
+    constexpr void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_chainedIter.stop_iteration();
+        m_firstEmpty = true;
+        m_secondEmpty = true;
+    }
+
+    constexpr size_t distance() const /* override */ { return this->m_iter.distance() + m_chainedIter.distance(); }
+
+    constexpr size_t split_size() const /* override */
+    {
+        return this->m_iter.split_size() + m_chainedIter.split_size();
+    }
+
+    constexpr Chain split_front(size_t n)
+    {
+        size_t const first = std::min(n, this->m_iter.split_size());
+        auto front = this->m_iter.split_front(first);
+        return Chain(std::move(front), m_chainedIter.split_front(n - first));
+    }
+
+    constexpr value_type get() /* override */ { return first_empty() ? m_chainedIter.get() : this->m_iter.get(); }
+
+    constexpr value_type get_back() /* override */
+    {
+        return second_empty() ? this->m_iter.get_back() : m_chainedIter.get_back();
+    }
+
+    constexpr value_type get_at(size_t n) /* override */
+    {
+        size_t const first = this->m_iter.distance();
+        return (n < first) ? this->m_iter.get_at(n) : m_chainedIter.get_at(n - first);
+    }
+
+    constexpr value_type next() /* override */ { return first_empty() ? m_chainedIter.next() : this->m_iter.next(); }
+
+    constexpr value_type next_back() /* override */
+    {
+        return second_empty() ? this->m_iter.next_back() : m_chainedIter.next_back();
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        size_t const num_steps = this->m_iter.advance_by(n);
+        return num_steps + m_chainedIter.advance_by(n - num_steps);
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        size_t const num_steps = m_chainedIter.advance_back_by(n);
+        return num_steps + this->m_iter.advance_back_by(n - num_steps);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, fn) && m_chainedIter.try_fold(acc, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return m_chainedIter.try_rfold(acc, fn) && this->m_iter.try_rfold(acc, fn);
+    }
+
+    // each half takes its own fast path
+    template <typename AccT, typename FnT, typename CombineT>
+    constexpr AccT accumulate(AccT init, FnT const& fn, CombineT const& combine) /* override */
+    {
+        AccT const first = this->m_iter.accumulate(init, fn, combine);
+        return combine(first, m_chainedIter.accumulate(std::move(init), fn, combine));
+    }
+
+    // a half that ran empty stays empty, so that it is not tested again for every element of the other half
+    constexpr bool first_empty() const
+    {
+        m_firstEmpty = m_firstEmpty || this->m_iter.empty();
+        return m_firstEmpty;
+    }
+
+    constexpr bool second_empty() const
+    {
+        m_secondEmpty = m_secondEmpty || m_chainedIter.empty();
+        return m_secondEmpty;
+    }
+
+    U m_chainedIter;
+    mutable bool m_firstEmpty = false;
+    mutable bool m_secondEmpty = false;
+};
+
+/// The segments of chain_all(), iterated in order. Folds run over each segment in its own loop, and next() only tests
+/// the segment at the front for emptiness rather than every segment before it.
+template <typename T, typename... Us>
+class [[nodiscard]] ChainAll final : public AdapterBase<T, ChainAll<T, Us...>> {
+public:
+    MOVE_ONLY(ChainAll);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = T::random_access && (Us::random_access && ...);
+    static constexpr bool bidirectional = T::bidirectional && (Us::bidirectional && ...);
+    static constexpr bool exact_size = T::exact_size && (Us::exact_size && ...);
+    static constexpr bool splittable = T::splittable && (Us::splittable && ...);
+    static constexpr bool bridged = T::bridged || (Us::bridged || ...);
+
+    static_assert((std::is_base_of_v<Adapter, Us> && ...), "Adapter required");
+    static_assert((std::is_same_v<value_type, typename Us::value_type> && ...),
+                  "Chained adapters must return the same value type");
+
+    constexpr explicit ChainAll(T&& t, Us&&... us)
+    : AdapterBase<T, ChainAll<T, Us...>>(std::move(t))
+    , m_segments(std::move(us)...)
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        SizeHint hint{0, 0};
+        for_each_segment([&hint](auto const& segment) {
+            auto const [lower, upper] = segment.size_hint();
+            hint.first = (hint.first + lower < lower) ? static_cast<size_t>(-1) : (hint.first + lower);
+            if (hint.second && upper && (*hint.second + *upper >= *upper)) {
+                *hint.second += *upper;
+            }
+            else {
+                hint.second.reset();
+            }
+        });
+        return hint;
+    }
+
+private:
+    static constexpr size_t Count = 1 + sizeof...(Us);
+
+    constexpr bool empty() const /* override */
+    {
+        const_cast<ChainAll&>(*this).seek_front();
+        return m_front == m_back;
+    }
+
+    constexpr void stop_iteration() /* override */
+    {
+        for_each_segment([](auto& segment) { segment.stop_iteration(); });
+        m_front = m_back;
+    }
+
+    constexpr size_t distance() const /* override */
+    {
+        size_t n = 0;
+        for_each_segment([&n](auto const& segment) { n += segment.distance(); });
+        return n;
+    }
+
+    constexpr size_t split_size() const /* override */
+    {
+        size_t n = 0;
+        for_each_segment([&n](auto const& segment) { n += segment.split_size(); });
+        return n;
+    }
+
+    constexpr ChainAll split_front(size_t n) { return split_front(n, std::index_sequence_for<Us...>{}); }
+
+    template <size_t... Is>
+    constexpr ChainAll split_front(size_t n, std::index_sequence<Is...>)
+    {
+        // the segments are split in order, so that the front part takes n elements from the first segments
+        size_t remaining = n;
+        auto take = [&remaining](auto& segment) {
+            size_t const k = std::min(remaining, segment.split_size());
+            remaining -= k;
+            return segment.split_front(k);
+        };
+        auto first = take(this->m_iter);
+        return std::apply([](auto&&... parts) { return ChainAll(std::move(parts)...); },
+                          std::tuple<T, Us...>{std::move(first), take(std::get<Is>(m_segments))...});
+    }
+
+    constexpr value_type get() /* override */
+    {
+        seek_front();
+        return on_segment(m_front, [](auto& segment) -> value_type { return segment.get(); });
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        seek_back();
+        return on_segment(m_back - 1, [](auto& segment) -> value_type { return segment.get_back(); });
+    }
+
+    constexpr value_type next() /* override */
+    {
+        seek_front();
+        return on_segment(m_front, [](auto& segment) -> value_type { return segment.next(); });
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        seek_back();
+        return on_segment(m_back - 1, [](auto& segment) -> value_type { return segment.next_back(); });
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        size_t num_steps = 0;
+        while ((num_steps < n) && (m_front != m_back)) {
+            size_t const k = n - num_steps;
+            num_steps += on_segment(m_front, [k](auto& segment) { return segment.advance_by(k); });
+            m_front += (num_steps < n);
+        }
+        return num_steps;
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        size_t num_steps = 0;
+        while ((num_steps < n) && (m_front != m_back)) {
+            size_t const k = n - num_steps;
+            num_steps += on_segment(m_back - 1, [k](auto& segment) { return segment.advance_back_by(k); });
+            m_back -= (num_steps < n);
+        }
+        return num_steps;
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        for (; m_front != m_back; ++m_front) {
+            if (!on_segment(m_front, [&acc, &fn](auto& segment) { return segment.try_fold(acc, fn); })) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        for (; m_front != m_back; --m_back) {
+            if (!on_segment(m_back - 1, [&acc, &fn](auto& segment) { return segment.try_rfold(acc, fn); })) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT, typename CombineT>
+    constexpr AccT accumulate(AccT init, FnT const& fn, CombineT const& combine) /* override */
+    {
+        AccT result = init;
+        for_each_segment([&](auto& segment) { result = combine(result, segment.accumulate(init, fn, combine)); });
+        m_front = m_back;
+        return result;
+    }
+
+    // segments that ran empty are passed over once, from either end
+    constexpr void seek_front()
+    {
+        while ((m_front != m_back) && on_segment(m_front, [](auto const& segment) { return segment.empty(); })) {
+            ++m_front;
+        }
+    }
+
+    constexpr void seek_back()
+    {
+        while ((m_front != m_back) && on_segment(m_back - 1, [](auto const& segment) { return segment.empty(); })) {
+            --m_back;
+        }
+    }
+
+    template <size_t I = 0, typename FnT>
+    constexpr decltype(auto) on_segment(size_t i, FnT&& fn)
+    {
+        if constexpr (I + 1 < Count) {
+            if (i != I) {
+                return on_segment<I + 1>(i, fn);
+            }
+        }
+        if constexpr (I == 0) {
+            return fn(this->m_iter);
+        }
+        else {
+            return fn(std::get<I - 1>(m_segments));
+        }
+    }
+
+    template <typename FnT>
+    constexpr void for_each_segment(FnT&& fn)
+    {
+        fn(this->m_iter);
+        std::apply([&fn](auto&... segments) { (fn(segments), ...); }, m_segments);
+    }
+
+    template <typename FnT>
+    constexpr void for_each_segment(FnT&& fn) const
+    {
+        fn(this->m_iter);
+        std::apply([&fn](auto const&... segments) { (fn(segments), ...); }, m_segments);
+    }
+
+    std::tuple<Us...> m_segments;
+    // the segments that may still hold elements
+    size_t m_front = 0;
+    size_t m_back = Count;
+};
+
+/// Batches of n consecutive elements, the last batch may be shorter (chunks()) or is left out (chunks_exact()).
+/// Batches of a contiguous range are views into it, other elements are gathered into a buffer that is reused, so that
+/// a batch stays valid only until the next batch is produced from the same end.
+template <typename T, bool Exact>
+class [[nodiscard]] Chunks final : public AdapterBase<T, Chunks<T, Exact>> {
+public:
+    MOVE_ONLY(Chunks);
+
+    ALL_FRIEND;
+
+    using element_type = std::conditional_t<
+        T::contiguous,
+        std::remove_reference_t<typename T::value_type>,
+        std::decay_t<typename T::value_type>>;
+    using value_type = Span<element_type>;
+
+    static constexpr bool splittable = T::splittable && T::contiguous;
+
+    static_assert((!Exact) || T::exact_size, "Only exact-sized adapters can be chunked exactly");
+
+    // a forward-only range cannot be trimmed at the back, so chunks_exact() counts the whole chunks left in it instead
+    static constexpr bool counted = Exact && (!T::bidirectional);
+
+    Chunks(T&& t, size_t n, std::pmr::memory_resource* resource)
+    : AdapterBase<T, Chunks<T, Exact>>(std::move(t))
+    , m_n(n)
+    , m_front{Items(resource)}
+    , m_back{Items(resource)}
+    {
+        assert(n != 0);
+        if constexpr (counted) {
+            m_whole = this->m_iter.distance() / m_n;
+        }
+        else if constexpr (Exact) {
+            this->m_iter.advance_back_by(this->m_iter.distance() % m_n);
+        }
+    }
+
+    value_type operator*() { return next(); }
+
+    SizeHint size_hint() const /* override */
+    {
+        if constexpr (counted) {
+            return {distance(), distance()};
+        }
+        auto const [lower, upper] = this->m_iter.size_hint();
+        size_t const buffered = m_front.filled + m_back.filled;
+        return {chunks(lower) + buffered, upper ? std::optional<size_t>(chunks(*upper) + buffered) : std::nullopt};
+    }
+
+private:
+    using Items = std::pmr::vector<std::decay_t<typename T::value_type>>;
+
+    struct Buffer final {
+        Items items;
+        bool filled = false;
+    };
+
+    bool empty() const /* override */
+    {
+        if constexpr (counted) {
+            return (m_whole == 0) && (!m_front.filled);
+        }
+        return this->m_iter.empty() && (!m_front.filled) && (!m_back.filled);
+    }
+
+    size_t distance() const /* override */
+    {
+        if constexpr (counted) {
+            return m_whole + m_front.filled;
+        }
+        return chunks(this->m_iter.distance()) + m_front.filled + m_back.filled;
+    }
+
+    size_t split_size() const /* override */ { return distance(); }
+
+    Chunks split_front(size_t n)
+    {
+        return Chunks(this->m_iter.split_front(inner_steps(n)), m_n, m_front.items.get_allocator().resource());
+    }
+
+    value_type get() /* override */
+    {
+        if constexpr (T::contiguous) {
+            return {this->m_iter.data(), std::min(m_n, this->m_iter.distance())};
+        }
+        else {
+            return view(fill_front());
+        }
+    }
+
+    value_type get_back() /* override */
+    {
+        if constexpr (T::contiguous) {
+            size_t const n = this->m_iter.distance();
+            size_t const k = back_size(n);
+            return {this->m_iter.data() + (n - k), k};
+        }
+        else {
+            return view(fill_back());
+        }
+    }
+
+    value_type next() /* override */
+    {
+        if constexpr (T::contiguous) {
+            auto* const data = this->m_iter.data();
+            return {data, this->m_iter.advance_by(m_n)};
+        }
+        else {
+            Buffer& buffer = fill_front();
+            buffer.filled = false;
+            return view(buffer);
+        }
+    }
+
+    value_type next_back() /* override */
+    {
+        if constexpr (T::contiguous) {
+            value_type chunk = get_back();
+            this->m_iter.advance_back_by(chunk.size());
+            return chunk;
+        }
+        else {
+            Buffer& buffer = fill_back();
+            buffer.filled = false;
+            return view(buffer);
+        }
+    }
+
+    void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_front.filled = false;
+        m_back.filled = false;
+        m_whole = 0;
+    }
+
+    size_t advance_by(size_t n) /* override */
+    {
+        size_t num_steps = 0;
+        if ((n != 0) && m_front.filled) {
+            m_front.filled = false;
+            ++num_steps;
+        }
+        if constexpr (counted) {
+            size_t const k = std::min(n - num_steps, m_whole);
+            this->m_iter.advance_by(k * m_n);
+            m_whole -= k;
+            return num_steps + k;
+        }
+        num_steps += chunks(this->m_iter.advance_by(inner_steps(n - num_steps)));
+        if ((num_steps < n) && m_back.filled) {
+            m_back.filled = false;
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    size_t advance_back_by(size_t n) /* override */
+    {
+        static_assert(T::exact_size, "Only exact-sized adapters can be chunked from the back");
+        size_t num_steps = 0;
+        if ((n != 0) && m_back.filled) {
+            m_back.filled = false;
+            ++num_steps;
+        }
+        if (num_steps < n) {
+            // the back chunk of chunks() may be shorter, all others are complete
+            size_t const total = this->m_iter.distance();
+            size_t const last = back_size(total);
+            size_t const inner = last + std::min(total - last, inner_steps(n - num_steps - 1));
+            this->m_iter.advance_back_by(inner);
+            num_steps += chunks(total) - chunks(total - inner);
+        }
+        if ((num_steps < n) && m_front.filled) {
+            m_front.filled = false;
+            ++num_steps;
+        }
+        return num_steps;
+    }
+
+    size_t chunks(size_t n) const { return Exact ? (n / m_n) : ((n / m_n) + ((n % m_n) != 0)); }
+
+    size_t back_size(size_t n) const { return ((n % m_n) != 0) ? (n % m_n) : std::min(n, m_n); }
+
+    size_t inner_steps(size_t n) const
+    {
+        return (n > static_cast<size_t>(-1) / m_n) ? static_cast<size_t>(-1) : n * m_n;
+    }
+
+    Buffer& fill_front()
+    {
+        if (m_front.filled) {
+            return m_front;
+        }
+        if (this->m_iter.empty() && m_back.filled) {
+            return m_back;
+        }
+        m_front.items.clear();
+        while ((m_front.items.size() < m_n) && (!this->m_iter.empty())) {
+            m_front.items.emplace_back(this->m_iter.next());
+        }
+        if constexpr (counted) {
+            --m_whole;
+        }
+        m_front.filled = true;
+        return m_front;
+    }
+
+    Buffer& fill_back()
+    {
+        static_assert(T::exact_size, "Only exact-sized adapters can be chunked from the back");
+        if (m_back.filled) {
+            return m_back;
+        }
+        if (this->m_iter.empty() && m_front.filled) {
+            return m_front;
+        }
+        m_back.items.clear();
+        for (size_t k = back_size(this->m_iter.distance()); k != 0; --k) {
+            m_back.items.emplace_back(this->m_iter.next_back());
+        }
+        std::reverse(m_back.items.begin(), m_back.items.end());
+        m_back.filled = true;
+        return m_back;
+    }
+
+    static value_type view(Buffer& buffer) { return {buffer.items.data(), buffer.items.size()}; }
+
+    size_t m_n;
+    Buffer m_front;
+    Buffer m_back;
+    size_t m_whole = 0;
+};
+
+/// Skips the elements equal to the one let through before them, a copy of that element is kept for the comparison.
+template <typename T>
+class [[nodiscard]] Dedup final : public AdapterBase<T, Dedup<T>> {
+public:
+    MOVE_ONLY(Dedup);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+
+    constexpr explicit Dedup(T&& t)
+    : AdapterBase<T, Dedup<T>>(std::move(t))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        return {(m_last || (lower == 0)) ? 0 : 1, upper};
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        const_cast<Dedup&>(*this).seek_front();
+        return this->m_iter.empty();
+    }
+
+    constexpr value_type get() /* override */
+    {
+        seek_front();
+        return this->m_iter.get();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        seek_front();
+        value_type item = this->m_iter.next();
+        m_last = item;
+        return std::forward<value_type>(item);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            if (m_last && (*m_last == item)) {
+                return true;
+            }
+            m_last = item;
+            return fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    constexpr void seek_front()
+    {
+        while (m_last && (!this->m_iter.empty()) && (*m_last == this->m_iter.get())) {
+            this->m_iter.advance_by(1);
+        }
+    }
+
+    std::optional<std::decay_t<value_type>> m_last;
+};
+
+template <typename T>
+class [[nodiscard]] Enumerate final : public AdapterBase<T, Enumerate<T>> {
+public:
+    MOVE_ONLY(Enumerate);
+
+    ALL_FRIEND;
+
+    using value_type = std::pair<size_t, typename T::value_type>;
+
+    static constexpr bool splittable = T::splittable && T::exact_size;
+    static constexpr bool indexed = T::indexed;
+
+    constexpr explicit Enumerate(T&& t)
+    : AdapterBase<T, Enumerate<T>>(std::move(t))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+private:
+    constexpr value_type get() /* override */ { return {m_i, this->m_iter.get()}; }
+
+    constexpr value_type get_back() /* override */
+    {
+        typename T::value_type item = this->m_iter.get_back();
+        size_t i = m_i + this->distance() - 1;
+        return {i, std::forward<typename T::value_type>(item)};
+    }
+
+    constexpr value_type get_at(size_t n) /* override */ { return {m_i + n, this->m_iter.get_at(n)}; }
+
+    constexpr value_type next() /* override */ { return {m_i++, this->m_iter.next()}; }
+
+    constexpr value_type next_back() /* override */
+    {
+        typename T::value_type item = this->m_iter.next_back();
+        size_t i = m_i + this->distance();
+        return {i, std::forward<typename T::value_type>(item)};
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        size_t const num_steps = this->m_iter.advance_by(n);
+        m_i += num_steps;
+        return num_steps;
+    }
+
+    constexpr Enumerate split_front(size_t n)
+    {
+        Enumerate front(this->m_iter.split_front(n));
+        front.m_i = m_i;
+        m_i += front.distance();
+        return front;
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            return fn(a, value_type{m_i++, std::forward<decltype(item)>(item)});
+        });
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        size_t i = m_i + this->distance();
+        return this->m_iter.try_rfold(acc, [&i, &fn](AccT& a, auto&& item) {
+            return fn(a, value_type{--i, std::forward<decltype(item)>(item)});
+        });
+    }
+
+    size_t m_i = 0;
+};
+
+template <typename T, typename FnT>
+class [[nodiscard]] Filter final : public AdapterBase<T, Filter<T, FnT>> {
+public:
+    MOVE_ONLY(Filter);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = T::splittable && std::is_copy_constructible_v<FnT>;
+    static constexpr bool contiguous_source = T::contiguous_source;
+
+    static_assert(std::is_invocable_v<FnT, typename T::value_type>, "Invocable required");
+    static_assert(std::is_convertible_v<std::invoke_result_t<FnT, typename T::value_type>, bool>, "Predicate must return bool");
+
+    constexpr Filter(T&& t, FnT&& fn)
+    : AdapterBase<T, Filter<T, FnT>>(std::move(t))
+    , m_predicate(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */ { return {0, this->m_iter.size_hint().second}; }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        // the non-matching elements are only skipped once an element is needed
+        const_cast<Filter&>(*this).seek_front();
+        return this->m_iter.empty();
+    }
+
+    constexpr value_type get() /* override */
+    {
+        seek_front();
+        return this->m_iter.get();
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        seek_back();
+        return this->m_iter.get_back();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        seek_front();
+        m_frontMatches = false;
+        return this->m_iter.next();
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        seek_back();
+        m_backMatches = false;
+        return this->m_iter.next_back();
+    }
+
+    constexpr void seek_front()
+    {
+        if (!m_frontMatches) {
+            this->m_iter.advance_while(m_predicate, false);
+            m_frontMatches = true;
+        }
+    }
+
+    constexpr void seek_back()
+    {
+        if (!m_backMatches) {
+            this->m_iter.advance_back_while(m_predicate, false);
+            m_backMatches = true;
+        }
+    }
+
+    template <typename U, typename SinkT>
+    constexpr void visit(U&& item, SinkT&& sink) /* override */
+    {
+        this->m_iter.visit(std::forward<U>(item), [this, &sink](auto&& inner) {
+            if (m_predicate(inner)) {
+                sink(std::forward<decltype(inner)>(inner));
+            }
+        });
+    }
+
+    constexpr Filter split_front(size_t n)
+    {
+        m_frontMatches = false;
+        return Filter(this->m_iter.split_front(n), FnT(m_predicate));
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        // a front element that was already found to match is not tested again
+        if (std::exchange(m_frontMatches, false) && (!this->m_iter.empty()) && (!fn(acc, this->m_iter.next()))) {
+            return false;
+        }
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            return (!m_predicate(item)) || fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_rfold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        if (std::exchange(m_backMatches, false) && (!this->m_iter.empty()) && (!fn(acc, this->m_iter.next_back()))) {
+            return false;
+        }
+        return this->m_iter.try_rfold(acc, [this, &fn](AccT& a, auto&& item) {
+            return (!m_predicate(item)) || fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    FnT m_predicate;
+    // whether the element at either end of the inner adapter is known to match
+    bool m_frontMatches = false;
+    bool m_backMatches = false;
+};
+
+/// the adapter over one element of flatten(), whose value type is ValueT
+template <typename ValueT, typename U>
+auto inner_adapter(U&& item)
+{
+    using PlainT = std::decay_t<ValueT>;
+    if constexpr (std::is_base_of_v<Adapter, PlainT>) {
+        static_assert(!std::is_reference_v<ValueT>, "Adapters must be yielded by value");
+        return PlainT(std::move(item));
+    }
+    else {
+        static_assert(Iterable<PlainT>, "Adapter or Iterable required");
+        if constexpr (std::is_lvalue_reference_v<ValueT>) {
+            using IterT = std::conditional_t<
+                std::is_const_v<std::remove_reference_t<ValueT>>,
+                typename PlainT::const_iterator,
+                typename PlainT::iterator>;
+            return Iterator<IterPair<PlainT, IterT>>(IterPair<PlainT, IterT>(item));
+        }
+        else if constexpr (std::is_rvalue_reference_v<ValueT>) {
+            using IterT = std::move_iterator<typename PlainT::iterator>;
+            return Iterator<IterPair<PlainT, IterT>>(IterPair<PlainT, IterT>(item));
+        }
+        else {
+            using IterT = std::move_iterator<typename PlainT::iterator>;
+            auto owner = std::make_shared<PlainT>(std::move(item));
+            return Iterator<IterPair<PlainT, IterT, true>>(IterPair<PlainT, IterT, true>(std::move(owner)));
+        }
+    }
+}
+
+/// The elements of each inner adapter in turn. The inner adapters at either end are kept while they are being
+/// iterated, folds run over each inner adapter in its own loop and contiguous inner elements are collected a span at a
+/// time.
+template <typename T>
+class [[nodiscard]] Flatten final : public AdapterBase<T, Flatten<T>> {
+    using OuterT = typename T::value_type;
+    using Inner = decltype(inner_adapter<OuterT>(std::declval<OuterT>()));
+
+public:
+    MOVE_ONLY(Flatten);
+
+    ALL_FRIEND;
+
+    using value_type = typename Inner::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = T::bidirectional && Inner::bidirectional;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+
+    explicit Flatten(T&& t)
+    : AdapterBase<T, Flatten<T>>(std::move(t))
+    {
+    }
+
+    value_type operator*() { return next(); }
+
+    SizeHint size_hint() const /* override */
+    {
+        auto const [frontLower, frontUpper] = m_front ? m_front->size_hint() : SizeHint{0, 0};
+        auto const [backLower, backUpper] = m_back ? m_back->size_hint() : SizeHint{0, 0};
+        size_t const sum = frontLower + backLower;
+        SizeHint hint{(sum < frontLower) ? static_cast<size_t>(-1) : sum, std::nullopt};
+        // the remaining inner adapters are unknown until they are reached
+        bool const outerEmpty = this->m_iter.size_hint().second == 0;
+        if (outerEmpty && frontUpper && backUpper && (*frontUpper + *backUpper >= *frontUpper)) {
+            hint.second = *frontUpper + *backUpper;
+        }
+        return hint;
+    }
+
+private:
+    bool empty() const /* override */
+    {
+        const_cast<Flatten&>(*this).seek_front();
+        return !has_elements(m_front) && !has_elements(m_back);
+    }
+
+    void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_front.reset();
+        m_back.reset();
+    }
+
+    value_type get() /* override */
+    {
+        seek_front();
+        return has_elements(m_front) ? m_front->get() : m_back->get();
+    }
+
+    value_type get_back() /* override */
+    {
+        seek_back();
+        return has_elements(m_back) ? m_back->get_back() : m_front->get_back();
+    }
+
+    value_type next() /* override */
+    {
+        seek_front();
+        return has_elements(m_front) ? m_front->next() : m_back->next();
+    }
+
+    value_type next_back() /* override */
+    {
+        seek_back();
+        return has_elements(m_back) ? m_back->next_back() : m_front->next_back();
+    }
+
+    size_t advance_by(size_t n) /* override */
+    {
+        size_t num_steps = 0;
+        while (num_steps < n) {
+            seek_front();
+            if (!has_elements(m_front)) {
+                num_steps += m_back ? m_back->advance_by(n - num_steps) : 0;
+                break;
+            }
+            num_steps += m_front->advance_by(n - num_steps);
+        }
+        return num_steps;
+    }
+
+    size_t advance_back_by(size_t n) /* override */
+    {
+        size_t num_steps = 0;
+        while (num_steps < n) {
+            seek_back();
+            if (!has_elements(m_back)) {
+                num_steps += m_front ? m_front->advance_back_by(n - num_steps) : 0;
+                break;
+            }
+            num_steps += m_back->advance_back_by(n - num_steps);
+        }
+        return num_steps;
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return fold_inner(acc, [&fn](AccT& a, Inner& inner) { return inner.try_fold(a, fn); });
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        if (m_back && !m_back->try_rfold(acc, fn)) {
+            return false;
+        }
+        m_back.reset();
+        bool const finished = this->m_iter.try_rfold(acc, [this, &fn](AccT& a, auto&& item) {
+            Inner inner = inner_adapter<OuterT>(std::forward<decltype(item)>(item));
+            if (inner.try_rfold(a, fn)) {
+                return true;
+            }
+            m_back.emplace(std::move(inner));
+            return false;
+        });
+        if (!finished || (m_front && !m_front->try_rfold(acc, fn))) {
+            return false;
+        }
+        m_front.reset();
+        return true;
+    }
+
+    template <typename AccT, typename FnT, typename CombineT>
+    AccT accumulate(AccT init, FnT const& fn, CombineT const& combine) /* override */
+    {
+        AccT result = init;
+        fold_inner(result, [&init, &fn, &combine](AccT& acc, Inner& inner) {
+            acc = combine(acc, inner.accumulate(init, fn, combine));
+            return true;
+        });
+        return result;
+    }
+
+    template <typename ContainerT>
+    ContainerT collect_into(ContainerT&& container) /* override */
+    {
+        if constexpr (Inner::contiguous) {
+            fold_inner(container, [](ContainerT& c, Inner& inner) {
+                Emplacer<ContainerT>::append(c, inner.source());
+                inner.stop_iteration();
+                return true;
+            });
+            return std::move(container);
+        }
+        else {
+            return AdapterBase<T, Flatten<T>>::collect_into(std::move(container));
+        }
+    }
+
+    // fn is called with each inner adapter from the front, the one it stops on is kept for later
+    template <typename AccT, typename InnerFnT>
+    bool fold_inner(AccT& acc, InnerFnT&& fn)
+    {
+        if (m_front && !fn(acc, *m_front)) {
+            return false;
+        }
+        m_front.reset();
+        bool const finished = this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            Inner inner = inner_adapter<OuterT>(std::forward<decltype(item)>(item));
+            if (fn(a, inner)) {
+                return true;
+            }
+            m_front.emplace(std::move(inner));
+            return false;
+        });
+        if (!finished || (m_back && !fn(acc, *m_back))) {
+            return false;
+        }
+        m_back.reset();
+        return true;
+    }
+
+    // the inner adapter at either end is replaced until it has elements or the outer adapter runs out
+    void seek_front()
+    {
+        while (!has_elements(m_front) && !this->m_iter.empty()) {
+            m_front.emplace(inner_adapter<OuterT>(this->m_iter.next()));
+        }
+    }
+
+    void seek_back()
+    {
+        while (!has_elements(m_back) && !this->m_iter.empty()) {
+            m_back.emplace(inner_adapter<OuterT>(this->m_iter.next_back()));
+        }
+    }
+
+    static bool has_elements(std::optional<Inner> const& inner) { return inner && !inner->empty(); }
+
+    std::optional<Inner> m_front;
+    std::optional<Inner> m_back;
+};
+
+/// Calls fn with a const reference to each element that leaves the upstream, including the elements that are skipped
+/// over (one at a time). Peeking at an element, as nth() and last() do for their result, does not inspect it.
+template <typename T, typename FnT>
+class [[nodiscard]] Inspect final : public AdapterBase<T, Inspect<T, FnT>> {
+public:
+    MOVE_ONLY(Inspect);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool splittable = T::splittable && std::is_copy_constructible_v<FnT>;
+    static constexpr bool contiguous_source = T::contiguous_source;
+
+    constexpr Inspect(T&& t, FnT&& fn)
+    : AdapterBase<T, Inspect<T, FnT>>(std::move(t))
+    , m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+private:
+    constexpr value_type next() /* override */
+    {
+        value_type item = this->m_iter.next();
+        m_f(std::as_const(item));
+        return std::forward<value_type>(item);
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        value_type item = this->m_iter.next_back();
+        m_f(std::as_const(item));
+        return std::forward<value_type>(item);
+    }
+
+    constexpr Inspect split_front(size_t n) { return Inspect(this->m_iter.split_front(n), FnT(m_f)); }
+
+    template <typename U, typename SinkT>
+    constexpr void visit(U&& item, SinkT&& sink) /* override */
+    {
+        this->m_iter.visit(std::forward<U>(item), [this, &sink](auto&& inner) {
+            m_f(std::as_const(inner));
+            sink(std::forward<decltype(inner)>(inner));
+        });
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            m_f(std::as_const(item));
+            return fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_rfold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, [this, &fn](AccT& a, auto&& item) {
+            m_f(std::as_const(item));
+            return fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    FnT m_f;
+};
+
+/// Counts the elements that leave the upstream (including those skipped over) and the time spent in the upstream,
+/// excluding the time spent downstream, and reports a ProfileRecord to the sink when destroyed. Each part of a
+/// parallel terminal reports separately.
+template <typename T, typename SinkT>
+class [[nodiscard]] Profile final : public AdapterBase<T, Profile<T, SinkT>> {
+public:
+    Profile(Profile const&) = delete;
+    Profile& operator=(Profile const&) = delete;
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool splittable = T::splittable && std::is_copy_constructible_v<SinkT>;
+
+    static_assert(std::is_invocable_v<SinkT&, ProfileRecord const&>, "Sink must accept a ProfileRecord");
+
+    Profile(T&& t, std::string name, SinkT&& sink)
+    : AdapterBase<T, Profile<T, SinkT>>(std::move(t))
+    , m_name(std::move(name))
+    , m_sink(std::forward<SinkT>(sink))
+    {
+    }
+
+    // moved-from stages do not report
+    Profile(Profile&& other) noexcept
+    : AdapterBase<T, Profile<T, SinkT>>(std::move(other))
+    , m_name(std::move(other.m_name))
+    , m_sink(std::move(other.m_sink))
+    , m_stats(other.m_stats)
+    , m_reporting(std::exchange(other.m_reporting, false))
+    {
+    }
+
+    Profile& operator=(Profile&& other) noexcept
+    {
+        report();
+        AdapterBase<T, Profile<T, SinkT>>::operator=(std::move(other));
+        m_name = std::move(other.m_name);
+        m_sink = std::move(other.m_sink);
+        m_stats = other.m_stats;
+        m_reporting = std::exchange(other.m_reporting, false);
+        return *this;
+    }
+
+    ~Profile() { report(); }
+
+    value_type operator*() { return next(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ProfileStats const* profile_stats() const /* override */ { return &m_stats; }
+
+    value_type next() /* override */
+    {
+        auto const start = Clock::now();
+        value_type item = this->m_iter.next();
+        m_stats.time += Clock::now() - start;
+        ++m_stats.elements;
+        return std::forward<value_type>(item);
+    }
+
+    value_type next_back() /* override */
+    {
+        auto const start = Clock::now();
+        value_type item = this->m_iter.next_back();
+        m_stats.time += Clock::now() - start;
+        ++m_stats.elements;
+        return std::forward<value_type>(item);
+    }
+
+    value_type get() /* override */
+    {
+        auto const start = Clock::now();
+        value_type item = this->m_iter.get();
+        m_stats.time += Clock::now() - start;
+        return std::forward<value_type>(item);
+    }
+
+    value_type get_back() /* override */
+    {
+        auto const start = Clock::now();
+        value_type item = this->m_iter.get_back();
+        m_stats.time += Clock::now() - start;
+        return std::forward<value_type>(item);
+    }
+
+    size_t advance_by(size_t n) /* override */
+    {
+        auto const start = Clock::now();
+        size_t const num_steps = this->m_iter.advance_by(n);
+        m_stats.time += Clock::now() - start;
+        m_stats.elements += num_steps;
+        return num_steps;
+    }
+
+    size_t advance_back_by(size_t n) /* override */
+    {
+        auto const start = Clock::now();
+        size_t const num_steps = this->m_iter.advance_back_by(n);
+        m_stats.time += Clock::now() - start;
+        m_stats.elements += num_steps;
+        return num_steps;
+    }
+
+    Profile split_front(size_t n) { return Profile(this->m_iter.split_front(n), m_name, SinkT(m_sink)); }
+
+    template <typename AccT, typename FnT>
+    bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return timed([this, &acc](auto const& f) { return this->m_iter.try_fold(acc, f); }, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return timed([this, &acc](auto const& f) { return this->m_iter.try_rfold(acc, f); }, fn);
+    }
+
+    // the clock is stopped while fn runs downstream
+    template <typename FoldT, typename FnT>
+    bool timed(FoldT const& fold, FnT& fn)
+    {
+        auto start = Clock::now();
+        bool const exhausted = fold([this, &fn, &start](auto& a, auto&& item) {
+            m_stats.time += Clock::now() - start;
+            ++m_stats.elements;
+            bool const more = fn(a, std::forward<decltype(item)>(item));
+            start = Clock::now();
+            return more;
+        });
+        m_stats.time += Clock::now() - start;
+        return exhausted;
+    }
+
+    void report()
+    {
+        if (!m_reporting) {
+            return;
+        }
+        m_reporting = false;
+        ProfileRecord record{m_name, m_stats.elements, m_stats.elements, m_stats.time, {}};
+        if (ProfileStats const* upstream = this->m_iter.profile_stats()) {
+            record.elements_in = upstream->elements;
+            record.upstream_time = upstream->time;
+        }
+        m_sink(std::as_const(record));
+    }
+
+    std::string m_name;
+    SinkT m_sink;
+    ProfileStats m_stats;
+    bool m_reporting = true;
+};
+
+/// Buffers up to N elements of the inner adapter in a ring of inline slots. References are buffered as references, so
+/// that peek() points to the element itself, and values are moved out of their slots once they are consumed.
+template <typename T, size_t N>
+class [[nodiscard]] Lookahead final : public AdapterBase<T, Lookahead<T, N>> {
+    using Slot = Fallible<typename T::value_type>;
+
+public:
+    MOVE_ONLY(Lookahead);
+
+    ALL_FRIEND;
+
+    using value_type = std::conditional_t<
+        std::is_lvalue_reference_v<typename T::value_type>,
+        typename T::value_type,
+        std::decay_t<typename T::value_type>>;
+
+    static constexpr bool random_access = false;
+    static constexpr bool splittable = false;
+
+    static_assert(N > 0, "At least one element must be buffered");
+
+    constexpr explicit Lookahead(T&& t)
+    : AdapterBase<T, Lookahead<T, N>>(std::move(t))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        size_t const sum = lower + m_size;
+        SizeHint hint{(sum < lower) ? static_cast<size_t>(-1) : sum, std::nullopt};
+        if (upper && (*upper + m_size >= *upper)) {
+            hint.second = *upper + m_size;
+        }
+        return hint;
+    }
+
+    /// the element i positions ahead (i < N), or nullptr when there are no more than i elements left
+    constexpr auto peek(size_t i = 0) /* -> value_type* */
+    {
+        assert(i < N);
+        fill(i + 1);
+        return (i < m_size) ? std::addressof(item(i)) : nullptr;
+    }
+
+    /// the next element, if there is one and it matches pred
+    template <typename PredT>
+    [[nodiscard]] constexpr Fallible<value_type> next_if(PredT const& pred)
+    {
+        Fallible<value_type> result;
+        auto* const front = peek();
+        if (front && pred(std::as_const(*front))) {
+            result.emplace(next());
+        }
+        return result;
+    }
+
+private:
+    constexpr bool empty() const /* override */ { return (m_size == 0) && this->m_iter.empty(); }
+
+    constexpr void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        clear(m_size);
+    }
+
+    constexpr size_t distance() const /* override */ { return m_size + this->m_iter.distance(); }
+
+    constexpr value_type get() /* override */
+    {
+        fill(1);
+        return item(0);
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        return this->m_iter.empty() ? item(m_size - 1) : this->m_iter.get_back();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        if (m_size == 0) {
+            return this->m_iter.next();
+        }
+        value_type front = std::forward<value_type>(item(0));
+        clear(1);
+        return std::forward<value_type>(front);
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        if (!this->m_iter.empty()) {
+            return this->m_iter.next_back();
+        }
+        --m_size;
+        value_type back = std::forward<value_type>(item(m_size));
+        slot(m_size).reset();
+        return std::forward<value_type>(back);
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        size_t const buffered = std::min(n, m_size);
+        clear(buffered);
+        return buffered + this->m_iter.advance_by(n - buffered);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        while (m_size != 0) {
+            if (!fn(acc, next())) {
+                return false;
+            }
+        }
+        return this->m_iter.try_fold(acc, fn);
+    }
+
+    // the inner adapter is read ahead until n elements are buffered
+    constexpr void fill(size_t n)
+    {
+        for (; (m_size < n) && !this->m_iter.empty(); ++m_size) {
+            slot(m_size).emplace(this->m_iter.next());
+        }
+    }
+
+    // the first n buffered elements are dropped
+    constexpr void clear(size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            slot(i).reset();
+        }
+        m_head = (m_head + n) % N;
+        m_size -= n;
+    }
+
+    constexpr Slot& slot(size_t i) { return m_slots[(m_head + i) % N]; }
+
+    constexpr auto& item(size_t i)
+    {
+        if constexpr (std::is_lvalue_reference_v<value_type>) {
+            return slot(i)->get();
+        }
+        else {
+            return *slot(i);
+        }
+    }
+
+    Slot m_slots[N];
+    // the buffered elements start at m_slots[m_head]
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+template <typename T, typename FnT>
+class [[nodiscard]] Map final : public AdapterBase<T, Map<T, FnT>> {
+public:
+    MOVE_ONLY(Map);
+
+    ALL_FRIEND;
+
+    using value_type = std::invoke_result_t<FnT, typename T::value_type>;
+
+    static constexpr bool splittable = T::splittable && std::is_copy_constructible_v<FnT>;
+    static constexpr bool indexed = T::indexed;
+    static constexpr bool contiguous_source = T::contiguous_source;
+
+    static_assert(std::is_invocable_v<FnT, typename T::value_type>, "Invocable required");
+
+    constexpr Map(T&& t, FnT&& fn)
+    : AdapterBase<T, Map<T, FnT>>(std::move(t))
+    , m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+private:
+    constexpr value_type get() /* override */ { return peek(this->m_iter.get()); }
+
+    constexpr value_type get_back() /* override */ { return peek(this->m_iter.get_back()); }
+
+    constexpr value_type get_at(size_t n) /* override */ { return peek(this->m_iter.get_at(n)); }
+
+    constexpr value_type next() /* override */ { return m_f(this->m_iter.next()); }
+
+    // Inspecting an element passes it as an lvalue, so that a function taking rvalue references does not move it out
+    // before next() yields it. Functions that only take rvalues are passed a copy, unless they return a reference.
+    template <typename U>
+    constexpr value_type peek(U&& item)
+    {
+        if constexpr (std::is_invocable_r_v<value_type, FnT&, U&>) {
+            return m_f(item);
+        }
+        else if constexpr (std::is_reference_v<value_type>) {
+            return m_f(std::forward<U>(item));
+        }
+        else {
+            static_assert(std::is_copy_constructible_v<std::decay_t<U>>, "Inspecting the element would move it");
+            return m_f(std::decay_t<U>(item));
+        }
+    }
+
+    constexpr value_type next_back() /* override */ { return m_f(this->m_iter.next_back()); }
+
+    constexpr Map split_front(size_t n) { return Map(this->m_iter.split_front(n), FnT(m_f)); }
+
+    constexpr void bound_to(size_t n) /* override */ { this->m_iter.bound_to(n); }
+
+    template <typename U, typename SinkT>
+    constexpr void visit(U&& item, SinkT&& sink) /* override */
+    {
+        this->m_iter.visit(std::forward<U>(item), [this, &sink](auto&& inner) {
+            sink(m_f(std::forward<decltype(inner)>(inner)));
+        });
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return this->m_iter.advance_by(n); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            return fn(a, m_f(std::forward<decltype(item)>(item)));
+        });
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_rfold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, [this, &fn](AccT& a, auto&& item) {
+            return fn(a, m_f(std::forward<decltype(item)>(item)));
+        });
+    }
+
+    FnT m_f;
+};
+
+/// Map that transforms each element at most once: the value of the front and back elements is cached while they
+/// are being inspected, and elements that are merely skipped over are never transformed.
+template <typename T, typename FnT>
+class [[nodiscard]] MapCached final : public AdapterBase<T, MapCached<T, FnT>> {
+public:
+    MOVE_ONLY(MapCached);
+
+    ALL_FRIEND;
+
+    using value_type = std::invoke_result_t<FnT, typename T::value_type>;
+
+    static_assert(std::is_invocable_v<FnT, typename T::value_type>, "Invocable required");
+    static constexpr bool splittable = T::splittable && std::is_copy_constructible_v<FnT>;
+
+    static_assert(!std::is_reference_v<value_type>, "Only values can be cached, use map() instead");
+
+    constexpr MapCached(T&& t, FnT&& fn)
+    : AdapterBase<T, MapCached<T, FnT>>(std::move(t))
+    , m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+private:
+    constexpr value_type get() /* override */
+    {
+        auto& slot = front_slot();
+        if (!slot) {
+            slot.emplace(m_f(this->m_iter.get()));
+        }
+        return *slot;
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        auto& slot = back_slot();
+        if (!slot) {
+            slot.emplace(m_f(this->m_iter.get_back()));
+        }
+        return *slot;
+    }
+
+    constexpr value_type next() /* override */
+    {
+        auto& slot = front_slot();
+        if (!slot) {
+            return m_f(this->m_iter.next());
+        }
+        value_type item = std::move(*slot);
+        slot.reset();
+        this->m_iter.advance_by(1);
+        return item;
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        auto& slot = back_slot();
+        if (!slot) {
+            return m_f(this->m_iter.next_back());
+        }
+        value_type item = std::move(*slot);
+        slot.reset();
+        this->m_iter.advance_back_by(1);
+        return item;
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        if (n != 0) {
+            m_front.reset();
+        }
+        return this->m_iter.advance_by(n);
+    }
+
+    constexpr MapCached split_front(size_t n)
+    {
+        m_front.reset();
+        m_back.reset();
+        return MapCached(this->m_iter.split_front(n), FnT(m_f));
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        if (n != 0) {
+            m_back.reset();
+        }
+        return this->m_iter.advance_back_by(n);
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        if (m_front && (!fn(acc, next()))) {
+            return false;
+        }
+        if (m_back) {
+            return AdapterBase<T, MapCached<T, FnT>>::try_fold(acc, fn);
+        }
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            return fn(a, m_f(std::forward<decltype(item)>(item)));
+        });
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_rfold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        if (m_back && (!fn(acc, next_back()))) {
+            return false;
+        }
+        if (m_front) {
+            return AdapterBase<T, MapCached<T, FnT>>::try_rfold(acc, fn);
+        }
+        return this->m_iter.try_rfold(acc, [this, &fn](AccT& a, auto&& item) {
+            return fn(a, m_f(std::forward<decltype(item)>(item)));
+        });
+    }
+
+    // when a single element is left, it may already be cached by the other end
+    constexpr bool single() const
+    {
+        if constexpr (T::random_access && T::exact_size) {
+            return this->m_iter.distance() == 1;
+        }
+        else {
+            return false;
+        }
+    }
+
+    constexpr std::optional<value_type>& front_slot() { return ((!m_front) && m_back && single()) ? m_back : m_front; }
+
+    constexpr std::optional<value_type>& back_slot() { return ((!m_back) && m_front && single()) ? m_front : m_back; }
+
+    FnT m_f;
+    std::optional<value_type> m_front;
+    std::optional<value_type> m_back;
+};
+
+/// Yields the values of the std::optionals that fn returns, until the first std::nullopt. fn is called once per
+/// element, a value is kept while it is inspected before it is consumed.
+template <typename T, typename FnT>
+class [[nodiscard]] MapWhile final : public AdapterBase<T, MapWhile<T, FnT>> {
+    using ResultT = std::invoke_result_t<FnT&, typename T::value_type>;
+
+public:
+    MOVE_ONLY(MapWhile);
+
+    ALL_FRIEND;
+
+    using value_type = typename ResultT::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+
+    static_assert(IsOptionalV<ResultT>, "Function must return a std::optional");
+
+    constexpr MapWhile(T&& t, FnT&& fn)
+    : AdapterBase<T, MapWhile<T, FnT>>(std::move(t))
+    , m_f(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        size_t const n = m_front ? 1 : 0;
+        if (m_done) {
+            return {n, n};
+        }
+        auto const upper = this->m_iter.size_hint().second;
+        return {n, upper ? std::optional<size_t>(*upper + n) : std::nullopt};
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        const_cast<MapWhile&>(*this).fill();
+        return !m_front;
+    }
+
+    constexpr void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_front.reset();
+        m_done = true;
+    }
+
+    constexpr value_type get() /* override */
+    {
+        fill();
+        return *m_front;
+    }
+
+    constexpr value_type next() /* override */
+    {
+        fill();
+        value_type item = std::move(*m_front);
+        m_front.reset();
+        return item;
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        if (m_front) {
+            value_type item = std::move(*m_front);
+            m_front.reset();
+            if (!fn(acc, std::move(item))) {
+                return false;
+            }
+        }
+        if (m_done) {
+            return true;
+        }
+        bool const completed = this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            ResultT result = m_f(std::forward<decltype(item)>(item));
+            if (!result) {
+                m_done = true;
+                return false;
+            }
+            return fn(a, std::move(*result));
+        });
+        return completed || m_done;
+    }
+
+    constexpr void fill()
+    {
+        if (!m_front && !m_done) {
+            if (!this->m_iter.empty()) {
+                m_front = m_f(this->m_iter.next());
+            }
+            m_done = !m_front;
+        }
+    }
+
+    FnT m_f;
+    // the front value, once it was computed
+    ResultT m_front;
+    bool m_done = false;
+};
+
+/// Two adapters sorted by compare, merged into one sorted sequence or matched as in std::set_union() and friends. The
+/// front elements are inspected with get() to pick the adapter that the next element comes from.
+template <typename T, typename U, typename CompareT, MergeOp Op>
+class [[nodiscard]] Merge final : public AdapterBase<T, Merge<T, U, CompareT, Op>> {
+public:
+    MOVE_ONLY(Merge);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = (Op == MergeOp::Merge) && T::bidirectional && U::bidirectional;
+    static constexpr bool exact_size = (Op == MergeOp::Merge) && T::exact_size && U::exact_size;
+    static constexpr bool splittable = false;
+
+    static_assert(std::is_base_of_v<Adapter, U>, "Adapter required");
+    static_assert(std::is_same_v<value_type, typename U::value_type>, "Merged adapter must return the same value type");
+
+    constexpr Merge(T&& t, U&& u, CompareT&& compare)
+    : AdapterBase<T, Merge<T, U, CompareT, Op>>(std::move(t))
+    , m_otherIter(std::move(u))
+    , m_compare(std::forward<CompareT>(compare))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        auto const [otherLower, otherUpper] = m_otherIter.size_hint();
+        if constexpr (Op == MergeOp::Intersection) {
+            return {0, (upper && otherUpper) ? std::min(upper, otherUpper) : (upper ? upper : otherUpper)};
+        }
+        else if constexpr (Op == MergeOp::Difference) {
+            return {0, upper};
+        }
+        else {
+            size_t const sum = lower + otherLower;
+            SizeHint hint{(sum < lower) ? static_cast<size_t>(-1) : sum, std::nullopt};
+            if (upper && otherUpper && (*upper + *otherUpper >= *upper)) {
+                hint.second = *upper + *otherUpper;
+            }
+            if constexpr (Op == MergeOp::Union) {
+                hint.first = std::max(lower, otherLower);
+            }
+            return hint;
+        }
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        if constexpr (Op == MergeOp::Merge || Op == MergeOp::Union) {
+            return this->m_iter.empty() && m_otherIter.empty();
+        }
+        else {
+            const_cast<Merge&>(*this).seek_front();
+            return this->m_iter.empty() || ((Op == MergeOp::Intersection) && m_otherIter.empty());
+        }
+    }
+
+    constexpr void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_otherIter.stop_iteration();
+    }
+
+    constexpr size_t distance() const /* override */ { return this->m_iter.distance() + m_otherIter.distance(); }
+
+    constexpr value_type get() /* override */
+    {
+        seek_front();
+        return from_first() ? this->m_iter.get() : m_otherIter.get();
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        return from_first_back() ? this->m_iter.get_back() : m_otherIter.get_back();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        seek_front();
+        if (!from_first()) {
+            return m_otherIter.next();
+        }
+        // the matching element of the other adapter is dropped
+        if constexpr (Op == MergeOp::Union) {
+            if (!m_otherIter.empty() && !precedes(this->m_iter.get(), m_otherIter.get())) {
+                m_otherIter.advance_by(1);
+            }
+        }
+        else if constexpr (Op == MergeOp::Intersection) {
+            m_otherIter.advance_by(1);
+        }
+        return this->m_iter.next();
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        return from_first_back() ? this->m_iter.next_back() : m_otherIter.next_back();
+    }
+
+    // whether the front element comes from this adapter, which it does for equal elements
+    constexpr bool from_first()
+    {
+        if constexpr (Op == MergeOp::Merge || Op == MergeOp::Union) {
+            return m_otherIter.empty() ||
+                   (!this->m_iter.empty() && !precedes(m_otherIter.get(), this->m_iter.get()));
+        }
+        else {
+            return true;
+        }
+    }
+
+    // from the back, equal elements come from the other adapter first
+    constexpr bool from_first_back()
+    {
+        return m_otherIter.empty() ||
+               (!this->m_iter.empty() && precedes(m_otherIter.get_back(), this->m_iter.get_back()));
+    }
+
+    // the elements that the set operation leaves out are skipped
+    constexpr void seek_front()
+    {
+        if constexpr (Op == MergeOp::Intersection || Op == MergeOp::Difference) {
+            while (!this->m_iter.empty() && !m_otherIter.empty()) {
+                if (precedes(this->m_iter.get(), m_otherIter.get())) {
+                    if constexpr (Op == MergeOp::Difference) {
+                        break;
+                    }
+                    this->m_iter.advance_by(1);
+                }
+                else if (precedes(m_otherIter.get(), this->m_iter.get())) {
+                    m_otherIter.advance_by(1);
+                }
+                else if constexpr (Op == MergeOp::Difference) {
+                    this->m_iter.advance_by(1);
+                    m_otherIter.advance_by(1);
+                }
+                else {
+                    break;
+                }
+            }
+        }
+    }
+
+    // the comparator sees const lvalues, an element that get() yields as an rvalue reference must not be moved out of
+    template <typename L, typename R>
+    constexpr bool precedes(L&& lhs, R&& rhs)
+    {
+        return m_compare(std::as_const(lhs), std::as_const(rhs));
+    }
+
+    U m_otherIter;
+    CompareT m_compare;
+};
+
+template <typename T>
+class [[nodiscard]] Reverse final : public AdapterBase<T, Reverse<T>> {
+public:
+    MOVE_ONLY(Reverse);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool splittable = false;
+    static constexpr bool indexed = T::indexed && T::exact_size;
+
+    static_assert(T::bidirectional, "Only bidirectional adapters can be reversed");
+
+    constexpr Reverse(T&& t)
+    : AdapterBase<T, Reverse<T>>(std::move(t))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+private:
+    constexpr value_type get() /* override */ { return this->m_iter.get_back(); }
+
+    constexpr value_type get_back() /* override */ { return this->m_iter.get(); }
+
+    constexpr value_type get_at(size_t n) /* override */
+    {
+        return this->m_iter.get_at(this->m_iter.distance() - 1 - n);
+    }
+
+    constexpr value_type next() /* override */ { return this->m_iter.next_back(); }
+
+    constexpr value_type next_back() /* override */ { return this->m_iter.next(); }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_by(n); }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, fn);
+    }
+};
+
+template <typename T>
+class [[nodiscard]] Skip final : public AdapterBase<T, Skip<T>> {
+public:
+    MOVE_ONLY(Skip);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool indexed = T::indexed;
+    static constexpr bool contiguous = T::contiguous;
+    static constexpr bool contiguous_source = T::contiguous;
+
+    constexpr Skip(T&& t, size_t n)
+    : AdapterBase<T, Skip<T>>(std::move(t))
+    {
+        this->advance_by(n);
+    }
+
+    constexpr value_type operator*() { return this->m_iter.next(); }
+
+private:
+    constexpr size_t advance_by(size_t n) /* override */ { return this->m_iter.advance_by(n); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    constexpr Skip split_front(size_t n) { return Skip(this->m_iter.split_front(n), 0); }
+
+    constexpr value_type get_at(size_t n) /* override */ { return this->m_iter.get_at(n); }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, fn);
+    }
+};
+
+/// Skips the leading elements that match fn once the first element is needed, from either end.
+template <typename T, typename FnT>
+class [[nodiscard]] SkipWhile final : public AdapterBase<T, SkipWhile<T, FnT>> {
+public:
+    MOVE_ONLY(SkipWhile);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+
+    constexpr SkipWhile(T&& t, FnT&& fn)
+    : AdapterBase<T, SkipWhile<T, FnT>>(std::move(t))
+    , m_predicate(std::forward<FnT>(fn))
+    {
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        return {m_skipped ? lower : 0, upper};
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        const_cast<SkipWhile&>(*this).skip_front();
+        return this->m_iter.empty();
+    }
+
+    constexpr value_type get() /* override */
+    {
+        skip_front();
+        return this->m_iter.get();
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        skip_front();
+        return this->m_iter.get_back();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        skip_front();
+        return this->m_iter.next();
+    }
+
+    constexpr value_type next_back() /* override */
+    {
+        skip_front();
+        return this->m_iter.next_back();
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        skip_front();
+        return this->m_iter.advance_by(n);
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        skip_front();
+        return this->m_iter.advance_back_by(n);
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        skip_front();
+        return this->m_iter.try_fold(acc, fn);
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_rfold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        skip_front();
+        return this->m_iter.try_rfold(acc, fn);
+    }
+
+    constexpr void skip_front()
+    {
+        if (!m_skipped) {
+            m_skipped = true;
+            this->m_iter.advance_while(m_predicate, true);
+        }
+    }
+
+    FnT m_predicate;
+    bool m_skipped = false;
+};
+
+/// Yields the elements in the order of compare, ties in no particular order. The elements are gathered once the first
+/// one is needed, and moved out as they are consumed. Behind take(n) only the first n are kept, in a bounded heap.
+template <typename T, typename CompareT>
+class [[nodiscard]] Sorted final : public AdapterBase<T, Sorted<T, CompareT>> {
+public:
+    MOVE_ONLY(Sorted);
+
+    ALL_FRIEND;
+
+    using value_type = std::decay_t<typename T::value_type>;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = true;
+    static constexpr bool exact_size = true;
+    static constexpr bool splittable = false;
+
+    Sorted(T&& t, CompareT&& compare, std::pmr::memory_resource* resource)
+    : AdapterBase<T, Sorted<T, CompareT>>(std::move(t))
+    , m_compare(std::forward<CompareT>(compare))
+    , m_buffer(resource)
+    {
+    }
+
+    value_type operator*() { return next(); }
+
+    SizeHint size_hint() const /* override */
+    {
+        if (m_filled || T::exact_size) {
+            size_t const n = distance();
+            return {n, n};
+        }
+        SizeHint hint = this->m_iter.size_hint();
+        if (m_limit) {
+            hint.first = std::min(hint.first, *m_limit);
+            hint.second = std::min(hint.second.value_or(*m_limit), *m_limit);
+        }
+        return hint;
+    }
+
+private:
+    using Buffer = std::pmr::vector<value_type>;
+
+    bool empty() const /* override */ { return distance() == 0; }
+
+    void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_filled = true;
+        m_front = m_back;
+    }
+
+    size_t distance() const /* override */
+    {
+        if constexpr (T::exact_size) {
+            if (!m_filled) {
+                size_t const n = this->m_iter.distance();
+                return m_limit ? std::min(n, *m_limit) : n;
+            }
+        }
+        const_cast<Sorted&>(*this).fill();
+        return m_back - m_front;
+    }
+
+    value_type get() /* override */
+    {
+        fill();
+        return m_buffer[m_front];
+    }
+
+    value_type get_back() /* override */
+    {
+        fill();
+        return m_buffer[m_back - 1];
+    }
+
+    value_type next() /* override */
+    {
+        fill();
+        return std::move(m_buffer[m_front++]);
+    }
+
+    value_type next_back() /* override */
+    {
+        fill();
+        return std::move(m_buffer[--m_back]);
+    }
+
+    size_t advance_by(size_t n) /* override */
+    {
+        fill();
+        size_t const num_steps = std::min(n, m_back - m_front);
+        m_front += num_steps;
+        return num_steps;
+    }
+
+    size_t advance_back_by(size_t n) /* override */
+    {
+        fill();
+        size_t const num_steps = std::min(n, m_back - m_front);
+        m_back -= num_steps;
+        return num_steps;
+    }
+
+    void bound_to(size_t n) /* override */
+    {
+        if (!m_filled) {
+            m_limit = std::min(n, m_limit.value_or(n));
+        }
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        fill();
+        while (m_front != m_back) {
+            if (!fn(acc, std::move(m_buffer[m_front++]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        fill();
+        while (m_front != m_back) {
+            if (!fn(acc, std::move(m_buffer[--m_back]))) {
+                return false;
             }
         }
-        return !b;
+        return true;
+    }
+
+    void fill()
+    {
+        if (m_filled) {
+            return;
+        }
+        m_filled = true;
+        if (m_limit) {
+            size_t const k = *m_limit;
+            m_buffer.reserve(std::min(k, this->m_iter.size_hint().first));
+            this->m_iter.try_fold(m_buffer, [this, k](Buffer& heap, auto&& item) {
+                push_bounded(heap, k, m_compare, std::forward<decltype(item)>(item));
+                return true;
+            });
+            std::sort_heap(m_buffer.begin(), m_buffer.end(), m_compare);
+        }
+        else {
+            m_buffer.reserve(this->m_iter.size_hint().first);
+            this->m_iter.try_fold(m_buffer, [](Buffer& buffer, auto&& item) {
+                buffer.emplace_back(std::forward<decltype(item)>(item));
+                return true;
+            });
+            std::sort(m_buffer.begin(), m_buffer.end(), m_compare);
+        }
+        m_back = m_buffer.size();
+    }
+
+    CompareT m_compare;
+    Buffer m_buffer;
+    // the unconsumed elements of the buffer
+    size_t m_front = 0;
+    size_t m_back = 0;
+    // the number of elements take() lets through
+    std::optional<size_t> m_limit;
+    bool m_filled = false;
+};
+
+template <typename T>
+class [[nodiscard]] StepBy final : public AdapterBase<T, StepBy<T>> {
+public:
+    MOVE_ONLY(StepBy);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool splittable = T::splittable && T::exact_size;
+    static constexpr bool indexed = T::indexed;
+
+    constexpr StepBy(T&& t, size_t step)
+    : AdapterBase<T, StepBy<T>>(std::move(t))
+    , m_step(step)
+    {
+        assert(step != 0);
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        return {steps(lower), upper ? std::optional<size_t>(steps(*upper)) : std::nullopt};
+    }
+
+private:
+    constexpr value_type next() /* override */
+    {
+        value_type item = this->m_iter.next();
+        this->m_iter.advance_by(get_step() - 1);
+        return std::forward<value_type>(item);
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        initial_step_back();
+        return this->m_iter.get_back();
+    }
+
+    // the front is always on a step
+    constexpr value_type get_at(size_t n) /* override */ { return this->m_iter.get_at(n * get_step()); }
+
+    constexpr value_type next_back() /* override */
+    {
+        initial_step_back();
+        value_type item = this->m_iter.next_back();
+        this->m_iter.advance_back_by(get_step() - 1);
+        return std::forward<value_type>(item);
+    }
+
+    constexpr size_t distance() const /* override */ { return steps(this->m_iter.distance()); }
+
+    constexpr size_t split_size() const /* override */ { return distance(); }
+
+    // the front part starts on a step and has no trimmed tail, the rest keeps its phase
+    constexpr StepBy split_front(size_t n) { return StepBy(this->m_iter.split_front(inner_steps(n)), get_step()); }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return steps(this->m_iter.advance_by(inner_steps(n))); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        initial_step_back();
+        return steps(this->m_iter.advance_back_by(inner_steps(n)));
+    }
+
+    constexpr size_t get_step() const { return m_step & (static_cast<size_t>(-1) >> 1); }
+
+    constexpr bool get_flag() const { return m_step & ~(static_cast<size_t>(-1) >> 1); }
+
+    constexpr size_t steps(size_t n) const { return (n == 0) ? 0 : 1 + (n - 1) / get_step(); }
+
+    constexpr size_t inner_steps(size_t n) const
+    {
+        return (n > static_cast<size_t>(-1) / get_step()) ? static_cast<size_t>(-1) : n * get_step();
+    }
+
+    constexpr void initial_step_back()
+    {
+        if (get_flag()) {
+            return;
+        }
+
+        m_step |= ~(static_cast<size_t>(-1) >> 1);
+        if (!this->empty()) {
+            this->m_iter.advance_back_by((this->m_iter.distance() - 1) % get_step());
+        }
+    }
+
+    size_t m_step;
+};
+
+template <typename T>
+class [[nodiscard]] Take final : public AdapterBase<T, Take<T>> {
+public:
+    MOVE_ONLY(Take);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool splittable = T::splittable && T::exact_size;
+    static constexpr bool indexed = T::indexed;
+    static constexpr bool contiguous = T::contiguous;
+    static constexpr bool contiguous_source = T::contiguous;
+
+    constexpr Take(T&& t, size_t n)
+    : AdapterBase<T, Take<T>>(std::move(t))
+    , m_n(n)
+    {
+        if (m_n == 0) {
+            this->stop_iteration();
+        }
+        this->m_iter.bound_to(m_n);
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        return {std::min(lower, m_n), std::min(upper.value_or(m_n), m_n)};
+    }
+
+private:
+    constexpr value_type next() /* override */
+    {
+        value_type item = this->m_iter.next();
+        if (--m_n == 0) {
+            this->stop_iteration();
+        }
+        return std::forward<value_type>(item);
+    }
+
+    constexpr value_type get_back() /* override */
+    {
+        trim_back();
+        return this->m_iter.get_back();
+    }
+
+    constexpr value_type get_at(size_t n) /* override */ { return this->m_iter.get_at(n); }
+
+    constexpr value_type next_back() /* override */
+    {
+        trim_back();
+        value_type item = this->m_iter.next_back();
+        if (--m_n == 0) {
+            this->stop_iteration();
+        }
+        return std::forward<value_type>(item);
+    }
+
+    constexpr size_t distance() const /* override */ { return std::min(m_n, this->m_iter.distance()); }
+
+    constexpr size_t split_size() const /* override */ { return distance(); }
+
+    constexpr auto source() const /* override */
+    {
+        auto const source = this->m_iter.source();
+        return std::decay_t<decltype(source)>{source.data(), std::min(m_n, source.size())};
+    }
+
+    constexpr Take split_front(size_t n)
+    {
+        size_t const num_steps = std::min(n, distance());
+        auto front = this->m_iter.split_front(num_steps);
+        consume(num_steps);
+        return Take(std::move(front), num_steps);
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */ { return consume(this->m_iter.advance_by(std::min(n, m_n))); }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        trim_back();
+        return consume(this->m_iter.advance_back_by(std::min(n, m_n)));
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        bool completed = true;
+        size_t n = m_n;
+        this->m_iter.try_fold(acc, [&fn, &completed, &n](AccT& a, auto&& item) {
+            completed = fn(a, std::forward<decltype(item)>(item));
+            return (--n != 0) && completed;
+        });
+        consume(m_n - n);
+        return completed;
+    }
+
+    template <typename AccT, typename FnT>
+    constexpr bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        trim_back();
+        bool completed = true;
+        size_t n = m_n;
+        this->m_iter.try_rfold(acc, [&fn, &completed, &n](AccT& a, auto&& item) {
+            completed = fn(a, std::forward<decltype(item)>(item));
+            return (--n != 0) && completed;
+        });
+        consume(m_n - n);
+        return completed;
+    }
+
+    constexpr size_t consume(size_t num_steps)
+    {
+        m_n -= num_steps;
+        if (m_n == 0) {
+            this->stop_iteration();
+        }
+        return num_steps;
+    }
+
+    // the back of the inner adapter is beyond the first m_n elements until it is trimmed
+    constexpr void trim_back()
+    {
+        static_assert(T::exact_size, "Only exact-sized adapters can be taken from the back");
+        if (!m_trimmed) {
+            m_trimmed = true;
+            size_t const n = this->m_iter.distance();
+            this->m_iter.advance_back_by(n - std::min(n, m_n));
+        }
+    }
+
+    size_t m_n;
+    bool m_trimmed = false;
+};
+
+/// Ends before the first element that does not match fn. Folds stop the upstream at that element, so that no further
+/// elements are filtered or mapped.
+template <typename T, typename FnT>
+class [[nodiscard]] TakeWhile final : public AdapterBase<T, TakeWhile<T, FnT>> {
+public:
+    MOVE_ONLY(TakeWhile);
+
+    ALL_FRIEND;
+
+    using value_type = typename T::value_type;
+
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
+
+    constexpr TakeWhile(T&& t, FnT&& fn)
+    : AdapterBase<T, TakeWhile<T, FnT>>(std::move(t))
+    , m_predicate(std::forward<FnT>(fn))
+    {
     }
 
-    auto fallible_deref() /* -> std::optional<value_type> */
+    constexpr value_type operator*() { return next(); }
+
+    constexpr SizeHint size_hint() const /* override */
     {
-        using value_type = decltype(downcast().next());
-        if constexpr (std::is_reference_v<value_type>) {
-            using return_type = std::optional<std::reference_wrapper<std::remove_reference_t<value_type>>>;
-            return (downcast().empty()) ? return_type{} : return_type{std::reference_wrapper(downcast().get())};
+        if (m_done) {
+            return {0, 0};
         }
-        else {
-            using return_type = std::optional<value_type>;
-            return (downcast().empty()) ? return_type{} : return_type{downcast().get()};
+        return {m_frontMatches ? 1 : 0, this->m_iter.size_hint().second};
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        const_cast<TakeWhile&>(*this).check_front();
+        return m_done;
+    }
+
+    constexpr void stop_iteration() /* override */
+    {
+        this->m_iter.stop_iteration();
+        m_done = true;
+    }
+
+    constexpr value_type get() /* override */
+    {
+        check_front();
+        return this->m_iter.get();
+    }
+
+    constexpr value_type next() /* override */
+    {
+        check_front();
+        m_frontMatches = false;
+        return this->m_iter.next();
+    }
+
+    template <typename AccT, typename FoldFnT>
+    constexpr bool try_fold(AccT& acc, FoldFnT&& fn) /* override */
+    {
+        if (m_done) {
+            return true;
         }
+        m_frontMatches = false;
+        bool const completed = this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            if (!m_predicate(std::as_const(item))) {
+                m_done = true;
+                return false;
+            }
+            return fn(a, std::forward<decltype(item)>(item));
+        });
+        return completed || m_done;
     }
 
-    inline AdapterT& downcast() { return const_cast<AdapterT&>(std::as_const(*this).downcast()); }
+    // the front element is tested once, the adapter ends when it does not match
+    constexpr void check_front()
+    {
+        if (!m_done && !m_frontMatches) {
+            if (this->m_iter.empty()) {
+                m_done = true;
+                return;
+            }
+            // an element yielded as an rvalue reference is tested without being moved out of
+            auto&& item = this->m_iter.get();
+            m_frontMatches = m_predicate(std::as_const(item));
+            m_done = !m_frontMatches;
+        }
+    }
 
-    inline AdapterT const& downcast() const { return *static_cast<AdapterT const*>(this); }
+    FnT m_predicate;
+    bool m_frontMatches = false;
+    bool m_done = false;
 };
 
-template <typename T>
-class [[nodiscard]] Iterator final : public AdapterBase<T, Iterator<T>> {
+/// Skips the elements that were let through before, a copy of each of them is kept in the set.
+template <typename T, typename SetT>
+class [[nodiscard]] Unique final : public AdapterBase<T, Unique<T, SetT>> {
 public:
-    MOVE_ONLY(Iterator);
+    MOVE_ONLY(Unique);
 
     ALL_FRIEND;
 
     using value_type = typename T::value_type;
 
-    static_assert(std::is_reference_v<value_type>);
+    static constexpr bool random_access = false;
+    static constexpr bool bidirectional = false;
+    static constexpr bool exact_size = false;
+    static constexpr bool splittable = false;
 
-    explicit Iterator(T&& t)
-    : AdapterBase<T, Iterator<T>>(std::move(t))
+    explicit Unique(T&& t)
+    : AdapterBase<T, Unique<T, SetT>>(std::move(t))
     {
     }
 
-    value_type operator*() { return this->m_iter.next(); }
+    value_type operator*() { return next(); }
+
+    SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        return {(!m_seen.empty() || (lower == 0)) ? 0 : 1, upper};
+    }
+
+private:
+    bool empty() const /* override */
+    {
+        const_cast<Unique&>(*this).seek_front();
+        return this->m_iter.empty();
+    }
+
+    value_type get() /* override */
+    {
+        seek_front();
+        return this->m_iter.get();
+    }
+
+    value_type next() /* override */
+    {
+        seek_front();
+        value_type item = this->m_iter.next();
+        m_seen.insert(item);
+        return std::forward<value_type>(item);
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        reserve_seen();
+        return this->m_iter.try_fold(acc, [this, &fn](AccT& a, auto&& item) {
+            return (!m_seen.insert(item).second) || fn(a, std::forward<decltype(item)>(item));
+        });
+    }
+
+    // the set is only reserved once elements are needed, and for no more than MaxReservedKeys of them
+    void reserve_seen()
+    {
+        if constexpr (Reservable<SetT>) {
+            if (!std::exchange(m_reserved, true)) {
+                m_seen.reserve(std::min(this->m_iter.size_hint().first, MaxReservedKeys));
+            }
+        }
+    }
+
+    void seek_front()
+    {
+        reserve_seen();
+        while ((!this->m_iter.empty()) && (m_seen.find(this->m_iter.get()) != m_seen.end())) {
+            this->m_iter.advance_by(1);
+        }
+    }
+
+    SetT m_seen;
+    bool m_reserved = false;
 };
 
-template <typename T, typename U>
-class [[nodiscard]] Chain final : public AdapterBase<T, Chain<T, U>> {
+template <typename T, typename ExecT>
+class [[nodiscard]] WithExecutor final : public AdapterBase<T, WithExecutor<T, ExecT>> {
 public:
-    MOVE_ONLY(Chain);
+    MOVE_ONLY(WithExecutor);
 
     ALL_FRIEND;
 
     using value_type = typename T::value_type;
 
-    static_assert(std::is_base_of_v<Adapter, U>, "Adapter required");
-    static_assert(
-        std::is_same_v<typename T::value_type, typename U::value_type>, "Chained adapter must return the same value type");
+    static constexpr bool contiguous = T::contiguous;
+    static constexpr bool contiguous_source = T::contiguous_source;
 
-    explicit Chain(T&& t, U&& u)
-    : AdapterBase<T, Chain<T, U>>(std::move(t))
-    , m_chainedIter(std::move(u))
+    static_assert(IsExecutorV<ExecT>, "Executor required");
+
+    WithExecutor(T&& t, ExecT& executor, size_t grain)
+    : AdapterBase<T, WithExecutor<T, ExecT>>(std::move(t))
+    , m_execution{&executor, grain}
+    {
+    }
+
+    value_type operator*() { return this->m_iter.next(); }
+
+private:
+    Execution<ExecT> execution() const /* override */ { return m_execution; }
+
+    size_t advance_by(size_t n) /* override */ { return this->m_iter.advance_by(n); }
+
+    size_t advance_back_by(size_t n) /* override */ { return this->m_iter.advance_back_by(n); }
+
+    WithExecutor split_front(size_t n)
+    {
+        return WithExecutor(this->m_iter.split_front(n), *m_execution.executor, m_execution.grain);
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_fold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_fold(acc, fn);
+    }
+
+    template <typename AccT, typename FnT>
+    bool try_rfold(AccT& acc, FnT&& fn) /* override */
+    {
+        return this->m_iter.try_rfold(acc, fn);
+    }
+
+    Execution<ExecT> m_execution;
+};
+
+/// Overlapping windows of n consecutive elements, advancing by one element. Windows of a contiguous range are views
+/// into it, other elements are read once into a buffer of 2 * n elements whose tail is moved to the front when it
+/// runs full, so that a window stays valid only until the next window is produced.
+template <typename T>
+class [[nodiscard]] Windows final : public AdapterBase<T, Windows<T>> {
+public:
+    MOVE_ONLY(Windows);
+
+    ALL_FRIEND;
+
+    using element_type = std::conditional_t<
+        T::contiguous,
+        std::remove_reference_t<typename T::value_type>,
+        std::decay_t<typename T::value_type>>;
+    using value_type = Span<element_type>;
+
+    static constexpr bool random_access = T::random_access && T::contiguous;
+    static constexpr bool splittable = false;
+
+    Windows(T&& t, size_t n, std::pmr::memory_resource* resource)
+    : AdapterBase<T, Windows<T>>(std::move(t))
+    , m_n(n)
+    , m_buffer(resource)
     {
+        assert(n != 0);
     }
 
     value_type operator*() { return next(); }
 
+    SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        size_t const n = buffered();
+        return {windows(lower + n), upper ? std::optional<size_t>(windows(*upper + n)) : std::nullopt};
+    }
+
 private:
-    bool empty() const /* override */ { return this->m_iter.empty() && m_chainedIter.empty(); }
+    bool empty() const /* override */
+    {
+        if constexpr (T::contiguous || T::exact_size) {
+            return distance() == 0;
+        }
+        else {
+            // only pulls the elements that the next window consists of anyway
+            const_cast<Windows&>(*this).prime();
+            return (!m_loaded) && ((m_buffer.size() < m_n - 1) || this->m_iter.empty());
+        }
+    }
+
+    size_t distance() const /* override */ { return windows(buffered() + this->m_iter.distance()); }
+
+    value_type get() /* override */
+    {
+        if constexpr (T::contiguous) {
+            return {this->m_iter.data(), m_n};
+        }
+        else {
+            load();
+            return {m_buffer.data() + (m_buffer.size() - m_n), m_n};
+        }
+    }
+
+    value_type get_back() /* override */
+    {
+        static_assert(T::contiguous, "Only contiguous adapters can be windowed from the back");
+        return {this->m_iter.data() + (this->m_iter.distance() - m_n), m_n};
+    }
+
+    value_type next() /* override */
+    {
+        value_type window = get();
+        if constexpr (T::contiguous) {
+            this->m_iter.advance_by(1);
+        }
+        else {
+            m_loaded = false;
+        }
+        return window;
+    }
+
+    value_type next_back() /* override */
+    {
+        value_type window = get_back();
+        this->m_iter.advance_back_by(1);
+        return window;
+    }
 
     void stop_iteration() /* override */
     {
         this->m_iter.stop_iteration();
-        m_chainedIter.stop_iteration();
+        m_buffer.clear();
+        m_loaded = false;
     }
 
-    size_t distance() const /* override */ { return this->m_iter.distance() + m_chainedIter.distance(); }
+    size_t advance_by(size_t n) /* override */
+    {
+        if constexpr (T::contiguous) {
+            return this->m_iter.advance_by(std::min(n, distance()));
+        }
+        else {
+            return AdapterBase<T, Windows<T>>::advance_by(n);
+        }
+    }
 
-    value_type get() /* override */ { return (!this->m_iter.empty()) ? this->m_iter.get() : m_chainedIter.get(); }
+    size_t advance_back_by(size_t n) /* override */
+    {
+        static_assert(T::contiguous, "Only contiguous adapters can be windowed from the back");
+        return this->m_iter.advance_back_by(std::min(n, distance()));
+    }
 
-    value_type get_back() /* override */
+    size_t windows(size_t n) const { return (n < m_n) ? 0 : (n - m_n + 1); }
+
+    // elements of the next window that were already read from the inner adapter
+    size_t buffered() const { return m_loaded ? m_n : std::min(m_buffer.size(), m_n - 1); }
+
+    void prime()
+    {
+        if (m_buffer.capacity() < 2 * m_n) {
+            m_buffer.reserve(2 * m_n);
+        }
+        while ((m_buffer.size() < m_n - 1) && (!this->m_iter.empty())) {
+            m_buffer.emplace_back(this->m_iter.next());
+        }
+    }
+
+    void load()
+    {
+        if (m_loaded) {
+            return;
+        }
+        prime();
+        if (m_buffer.size() == 2 * m_n) {
+            auto const tail = m_buffer.end() - static_cast<std::ptrdiff_t>(m_n - 1);
+            std::move(tail, m_buffer.end(), m_buffer.begin());
+            m_buffer.erase(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_n - 1), m_buffer.end());
+        }
+        m_buffer.emplace_back(this->m_iter.next());
+        m_loaded = true;
+    }
+
+    size_t m_n;
+    std::pmr::vector<std::decay_t<typename T::value_type>> m_buffer;
+    bool m_loaded = false;
+};
+
+template <typename T, typename U>
+class [[nodiscard]] Zip final : public AdapterBase<T, Zip<T, U>> {
+public:
+    MOVE_ONLY(Zip);
+
+    ALL_FRIEND;
+
+    using value_type = std::pair<typename T::value_type, typename U::value_type>;
+
+    static constexpr bool random_access = T::random_access && U::random_access;
+    static constexpr bool bidirectional = T::bidirectional && U::bidirectional;
+    static constexpr bool exact_size = T::exact_size && U::exact_size;
+    static constexpr bool splittable = T::splittable && U::splittable && exact_size;
+    static constexpr bool indexed = T::indexed && U::indexed;
+    static constexpr bool bridged = T::bridged || U::bridged;
+
+    static_assert(std::is_base_of_v<Adapter, U>, "Adapter required");
+
+    constexpr explicit Zip(T&& t, U&& u)
+    : AdapterBase<T, Zip<T, U>>(std::move(t))
+    , m_zippedIter(std::move(u))
     {
-        return (!this->m_chainedIter.empty()) ? m_chainedIter.get_back() : this->m_iter.get_back();
     }
 
-    value_type next() /* override */ { return (!this->m_iter.empty()) ? this->m_iter.next() : m_chainedIter.next(); }
+    constexpr value_type operator*() { return next(); }
 
-    value_type next_back() /* override */
+    /// sum of the products of the pairs, folded in lanes over contiguous elements like sum()
+    [[nodiscard]] constexpr auto dot()
     {
-        return (!this->m_chainedIter.empty()) ? m_chainedIter.next_back() : this->m_iter.next_back();
+        using ResultT = std::common_type_t<std::decay_t<typename T::value_type>, std::decay_t<typename U::value_type>>;
+        using AccT = AccumulatorT<ResultT>;
+        if constexpr (T::contiguous && U::contiguous) {
+            AccT result{};
+            if (!empty()) {
+                auto* const lhs = this->m_iter.data();
+                auto* const rhs = m_zippedIter.data();
+                result = lanes_fold(
+                    distance(),
+                    AccT{},
+                    [lhs, rhs](AccT& acc, size_t i) {
+                        acc = acc + static_cast<AccT>(lhs[i]) * static_cast<AccT>(rhs[i]);
+                    },
+                    std::plus<AccT>{});
+            }
+            this->stop_iteration();
+            return static_cast<ResultT>(result);
+        }
+        else {
+            return static_cast<ResultT>(this->fold(AccT{}, [](AccT acc, value_type pair) {
+                return acc + static_cast<AccT>(pair.first) * static_cast<AccT>(pair.second);
+            }));
+        }
     }
 
-    U m_chainedIter;
+    constexpr SizeHint size_hint() const /* override */
+    {
+        auto const [lower, upper] = this->m_iter.size_hint();
+        auto const [zippedLower, zippedUpper] = m_zippedIter.size_hint();
+        SizeHint hint{std::min(lower, zippedLower), upper ? upper : zippedUpper};
+        if (upper && zippedUpper) {
+            hint.second = std::min(*upper, *zippedUpper);
+        }
+        return hint;
+    }
+
+private:
+    constexpr bool empty() const /* override */ { return this->m_iter.empty() || m_zippedIter.empty(); }
+
+    constexpr size_t distance() const /* override */
+    {
+        return std::min(this->m_iter.distance(), m_zippedIter.distance());
+    }
+
+    constexpr size_t split_size() const /* override */ { return distance(); }
+
+    constexpr Zip split_front(size_t n)
+    {
+        auto front = this->m_iter.split_front(n);
+        return Zip(std::move(front), m_zippedIter.split_front(n));
+    }
+
+    constexpr value_type get() /* override */ { return {this->m_iter.get(), m_zippedIter.get()}; }
+
+    constexpr value_type get_at(size_t n) /* override */ { return {this->m_iter.get_at(n), m_zippedIter.get_at(n)}; }
+
+    constexpr value_type get_back() /* override */
+    {
+        trim_back();
+        return {this->m_iter.get_back(), m_zippedIter.get_back()};
+    }
+
+    constexpr value_type next() /* override */ { return {this->m_iter.next(), m_zippedIter.next()}; }
+
+    constexpr value_type next_back() /* override */
+    {
+        trim_back();
+        return {this->m_iter.next_back(), m_zippedIter.next_back()};
+    }
+
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        return std::min(this->m_iter.advance_by(n), m_zippedIter.advance_by(n));
+    }
+
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        trim_back();
+        return std::min(this->m_iter.advance_back_by(n), m_zippedIter.advance_back_by(n));
+    }
+
+    // the longer side is trimmed to the length of the shorter one before anything is taken from the back
+    constexpr void trim_back()
+    {
+        if constexpr (exact_size) {
+            if (!m_trimmed) {
+                m_trimmed = true;
+                size_t const n = distance();
+                this->m_iter.advance_back_by(this->m_iter.distance() - n);
+                m_zippedIter.advance_back_by(m_zippedIter.distance() - n);
+            }
+        }
+    }
+
+    U m_zippedIter;
+    bool m_trimmed = false;
 };
 
-template <typename T>
-class [[nodiscard]] Enumerate final : public AdapterBase<T, Enumerate<T>> {
+/// The rows of zip_all(), one element of every column at a time as a flat std::tuple. Exact-sized columns advance in
+/// lockstep under a single row count. Contiguous columns are folded in lanes through the first column, where the
+/// offset of an element is the index of its row in every other column.
+template <typename T, typename... Us>
+class [[nodiscard]] ZipAll final : public AdapterBase<T, ZipAll<T, Us...>> {
+    // The rows of contiguous columns, indexed like a span by the lanes of accumulate(): data() is the rows themselves,
+    // which are copied into the loop along with the column pointers, and row i is assembled from element i of each.
+    template <typename... PointerTs>
+    struct Rows final {
+        constexpr size_t size() const { return rows; }
+
+        constexpr Rows data() const { return *this; }
+
+        constexpr auto operator[](size_t i) const { return row(i, std::index_sequence_for<PointerTs...>{}); }
+
+        template <size_t... Is>
+        constexpr auto row(size_t i, std::index_sequence<Is...>) const
+        {
+            using RowT = std::tuple<typename T::value_type, typename Us::value_type...>;
+            return RowT{static_cast<std::tuple_element_t<Is, RowT>>(std::get<Is>(columns)[i])...};
+        }
+
+        std::tuple<PointerTs...> columns;
+        size_t rows;
+    };
+
 public:
-    MOVE_ONLY(Enumerate);
+    MOVE_ONLY(ZipAll);
 
     ALL_FRIEND;
 
-    using value_type = std::pair<size_t, typename T::value_type>;
+    using value_type = std::tuple<typename T::value_type, typename Us::value_type...>;
+
+    static constexpr bool random_access = T::random_access && (Us::random_access && ...);
+    static constexpr bool exact_size = T::exact_size && (Us::exact_size && ...);
+    // the columns are aligned at the back by their lengths
+    static constexpr bool bidirectional = T::bidirectional && (Us::bidirectional && ...) && exact_size;
+    static constexpr bool splittable = T::splittable && (Us::splittable && ...) && exact_size;
+    static constexpr bool bridged = T::bridged || (Us::bridged || ...);
+    static constexpr bool contiguous_source = T::contiguous && (Us::contiguous && ...);
+
+    static_assert((std::is_base_of_v<Adapter, Us> && ...), "Adapter required");
+
+    constexpr explicit ZipAll(T&& t, Us&&... us)
+    : AdapterBase<T, ZipAll<T, Us...>>(std::move(t))
+    , m_columns(std::move(us)...)
+    {
+        if constexpr (exact_size) {
+            m_rows = this->m_iter.distance();
+            for_each_column([this](auto const& column) { m_rows = std::min(m_rows, column.distance()); });
+        }
+    }
+
+    constexpr value_type operator*() { return next(); }
+
+    /// the remaining rows of contiguous columns, as one span per column
+    constexpr auto columns() const /* -> std::tuple<Span...> */
+    {
+        static_assert(contiguous_source, "Contiguous columns required");
+        return std::apply(
+            [this](auto const&... columns) {
+                return std::make_tuple(span(this->m_iter), span(columns)...);
+            },
+            m_columns);
+    }
+
+    /// the remaining rows of contiguous columns in chunks of up to n rows, each as one span per column; the spans
+    /// point into the containers, which must outlive them
+    constexpr auto column_chunks(size_t n) const
+    {
+        size_t const rows = distance();
+        auto chunk = [all = columns(), n, rows](size_t first) {
+            return std::apply(
+                [first, k = std::min(n, rows - first)](auto const&... column) {
+                    return std::make_tuple(std::decay_t<decltype(column)>{column.data() + first, k}...);
+                },
+                all);
+        };
+        return Iterator<Range<size_t>>(Range<size_t>(0, rows, n)).map(std::move(chunk));
+    }
+
+    constexpr SizeHint size_hint() const /* override */
+    {
+        if constexpr (exact_size) {
+            return {m_rows, m_rows};
+        }
+        else {
+            SizeHint hint{static_cast<size_t>(-1), std::nullopt};
+            for_each_column([&hint](auto const& column) {
+                auto const [lower, upper] = column.size_hint();
+                hint.first = std::min(hint.first, lower);
+                if (upper) {
+                    hint.second = hint.second ? std::min(*hint.second, *upper) : *upper;
+                }
+            });
+            return hint;
+        }
+    }
+
+private:
+    constexpr bool empty() const /* override */
+    {
+        if constexpr (exact_size) {
+            return m_rows == 0;
+        }
+        else {
+            bool empty = false;
+            for_each_column([&empty](auto const& column) { empty = empty || column.empty(); });
+            return empty;
+        }
+    }
 
-    explicit Enumerate(T&& t)
-    : AdapterBase<T, Enumerate<T>>(std::move(t))
+    constexpr void stop_iteration() /* override */
     {
+        for_each_column([](auto& column) { column.stop_iteration(); });
+        m_rows = 0;
     }
 
-    value_type operator*() { return next(); }
+    constexpr size_t distance() const /* override */ { return m_rows; }
 
-private:
-    value_type get() /* override */ { return {m_i, this->m_iter.get()}; }
+    constexpr size_t split_size() const /* override */ { return m_rows; }
 
-    value_type get_back() /* override */
+    constexpr ZipAll split_front(size_t n)
     {
-        typename T::value_type item = this->m_iter.get_back();
-        size_t i = m_i + this->distance();
-        return {i, item};
+        return split_front(std::min(n, m_rows), std::index_sequence_for<Us...>{});
     }
 
-    value_type next() /* override */ { return {m_i++, this->m_iter.next()}; }
-
-    value_type next_back() /* override */
+    template <size_t... Is>
+    constexpr ZipAll split_front(size_t n, std::index_sequence<Is...>)
     {
-        typename T::value_type item = this->m_iter.next_back();
-        size_t i = m_i + this->distance();
-        return {i, item};
+        m_rows -= n;
+        auto first = this->m_iter.split_front(n);
+        return ZipAll(std::move(first), std::get<Is>(m_columns).split_front(n)...);
     }
 
-    size_t m_i = 0;
-};
-
-template <typename T, typename FnT>
-class [[nodiscard]] Filter final : public AdapterBase<T, Filter<T, FnT>> {
-public:
-    MOVE_ONLY(Filter);
-
-    ALL_FRIEND;
-
-    using value_type = typename T::value_type;
-
-    static_assert(std::is_invocable_v<FnT, typename T::value_type>, "Invocable required");
-    static_assert(std::is_convertible_v<std::invoke_result_t<FnT, typename T::value_type>, bool>, "Predicate must return bool");
-
-    Filter(T&& t, FnT&& fn)
-    : AdapterBase<T, Filter<T, FnT>>(std::move(t))
-    , m_predicate(std::forward<FnT>(fn))
+    constexpr value_type get() /* override */
     {
-        this->m_iter.advance_while(m_predicate, false);
-        this->m_iter.advance_back_while(m_predicate, false);
+        return std::apply(
+            [this](auto&... columns) { return value_type{this->m_iter.get(), columns.get()...}; }, m_columns);
     }
 
-    value_type operator*() { return next(); }
-
-private:
-    value_type next() /* override */
+    constexpr value_type get_back() /* override */
     {
-        value_type item = this->m_iter.next();
-        this->m_iter.advance_while(m_predicate, false);
-        return item;
+        trim_back();
+        return std::apply(
+            [this](auto&... columns) { return value_type{this->m_iter.get_back(), columns.get_back()...}; },
+            m_columns);
     }
 
-    value_type next_back() /* override */
+    // the elements are taken in column order, as braced initializers are evaluated from left to right
+    constexpr value_type next() /* override */
     {
-        value_type item = this->m_iter.next_back();
-        this->m_iter.advance_back_while(m_predicate, false);
-        return item;
+        if constexpr (exact_size) {
+            --m_rows;
+        }
+        return std::apply(
+            [this](auto&... columns) { return value_type{this->m_iter.next(), columns.next()...}; }, m_columns);
     }
 
-    FnT m_predicate;
-};
-
-template <typename T, typename FnT>
-class [[nodiscard]] Map final : public AdapterBase<T, Map<T, FnT>> {
-public:
-    MOVE_ONLY(Map);
-
-    ALL_FRIEND;
+    constexpr value_type next_back() /* override */
+    {
+        trim_back();
+        --m_rows;
+        return std::apply(
+            [this](auto&... columns) { return value_type{this->m_iter.next_back(), columns.next_back()...}; },
+            m_columns);
+    }
 
-    using value_type = std::invoke_result_t<FnT, typename T::value_type>;
+    constexpr size_t advance_by(size_t n) /* override */
+    {
+        if constexpr (exact_size) {
+            size_t const num_steps = std::min(n, m_rows);
+            for_each_column([num_steps](auto& column) { column.advance_by(num_steps); });
+            m_rows -= num_steps;
+            return num_steps;
+        }
+        else {
+            size_t num_steps = n;
+            for_each_column([n, &num_steps](auto& column) { num_steps = std::min(num_steps, column.advance_by(n)); });
+            return num_steps;
+        }
+    }
 
-    static_assert(std::is_invocable_v<FnT, typename T::value_type>, "Invocable required");
+    constexpr size_t advance_back_by(size_t n) /* override */
+    {
+        trim_back();
+        size_t const num_steps = std::min(n, m_rows);
+        for_each_column([num_steps](auto& column) { column.advance_back_by(num_steps); });
+        m_rows -= num_steps;
+        return num_steps;
+    }
 
-    Map(T&& t, FnT&& fn)
-    : AdapterBase<T, Map<T, FnT>>(std::move(t))
-    , m_f(std::forward<FnT>(fn))
+    constexpr auto source() const /* override */
     {
+        return std::apply(
+            [this](auto const&... columns) {
+                using RowsT = Rows<decltype(span(this->m_iter).data()), decltype(span(columns).data())...>;
+                return RowsT{{span(this->m_iter).data(), span(columns).data()...}, m_rows};
+            },
+            m_columns);
     }
 
-    value_type operator*() { return next(); }
+    // the rows of source() are elements already
+    template <typename U, typename SinkT>
+    constexpr void visit(U&& row, SinkT&& sink) /* override */
+    {
+        sink(std::forward<U>(row));
+    }
 
-private:
-    value_type get() /* override */ { return m_f(this->m_iter.get()); }
+    // the longer columns are trimmed to the row count before anything is taken from the back
+    constexpr void trim_back()
+    {
+        if (!m_trimmed) {
+            m_trimmed = true;
+            for_each_column([this](auto& column) { column.advance_back_by(column.distance() - m_rows); });
+        }
+    }
 
-    value_type get_back() /* override */ { return m_f(this->m_iter.get_back()); }
+    // the remaining rows of a column, which may be longer than the others
+    template <typename ColumnT>
+    constexpr auto span(ColumnT const& column) const
+    {
+        auto const source = column.source();
+        return std::decay_t<decltype(source)>{source.data(), m_rows};
+    }
 
-    value_type next() /* override */ { return m_f(this->m_iter.next()); }
+    template <typename FnT>
+    constexpr void for_each_column(FnT&& fn)
+    {
+        fn(this->m_iter);
+        std::apply([&fn](auto&... columns) { (fn(columns), ...); }, m_columns);
+    }
 
-    value_type next_back() /* override */ { return m_f(this->m_iter.next_back()); }
+    template <typename FnT>
+    constexpr void for_each_column(FnT&& fn) const
+    {
+        fn(this->m_iter);
+        std::apply([&fn](auto const&... columns) { (fn(columns), ...); }, m_columns);
+    }
 
-    FnT m_f;
+    std::tuple<Us...> m_columns;
+    // the number of rows left when the columns are exact-sized
+    size_t m_rows = 0;
+    bool m_trimmed = false;
 };
 
-template <typename T>
-class [[nodiscard]] Reverse final : public AdapterBase<T, Reverse<T>> {
+#if defined(__cpp_lib_ranges)
+/// Input iterator over an adapter: dereferencing inspects the front element with get(), which recomputes it, and
+/// incrementing skips it with advance_by(), which does not compute it at all.
+template <typename AdapterT>
+class RangeIterator final {
 public:
-    MOVE_ONLY(Reverse);
+    using iterator_concept = std::input_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::remove_cvref_t<typename AdapterT::value_type>;
+    using difference_type = std::ptrdiff_t;
+    using reference = typename AdapterT::value_type;
 
-    ALL_FRIEND;
+    RangeIterator() = default;
 
-    using value_type = typename T::value_type;
+    explicit RangeIterator(AdapterT* adapter)
+    : m_adapter(adapter)
+    {
+    }
 
-    static_assert(
-        IsBidirectionalV<typename AdapterBase<T, Reverse<T>>::std_iterator>, "Only bidirectional iterators can be reversed");
+    reference operator*() const { return m_adapter->get(); }
 
-    Reverse(T&& t)
-    : AdapterBase<T, Reverse<T>>(std::move(t))
+    RangeIterator& operator++()
     {
+        m_adapter->advance_by(1);
+        return *this;
     }
 
-    value_type operator*() { return next(); }
-
-private:
-    value_type get() /* override */ { return this->m_iter.get_back(); }
+    void operator++(int) { ++*this; }
 
-    value_type get_back() /* override */ { return this->m_iter.get(); }
+    friend bool operator==(RangeIterator const& it, std::default_sentinel_t) { return it.at_end(); }
 
-    value_type next() /* override */ { return this->m_iter.next_back(); }
+private:
+    bool at_end() const { return m_adapter->empty(); }
 
-    value_type next_back() /* override */ { return this->m_iter.next(); }
+    AdapterT* m_adapter = nullptr;
 };
 
-template <typename T>
-class [[nodiscard]] Skip final : public AdapterBase<T, Skip<T>> {
+/// Random access iterator over an indexed, exact-sized adapter: an offset from its front that is read with get_at(), so
+/// that the adapter itself never moves. Like those of std::views::transform, iterators over computed elements are only
+/// input iterators to the algorithms that go by iterator_category.
+template <typename AdapterT>
+class IndexedRangeIterator final {
 public:
-    MOVE_ONLY(Skip);
-
-    ALL_FRIEND;
-
-    using value_type = typename T::value_type;
-
-    Skip(T&& t, size_t n)
-    : AdapterBase<T, Skip<T>>(std::move(t))
+    using reference = typename AdapterT::value_type;
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::
+        conditional_t<std::is_lvalue_reference_v<reference>, std::random_access_iterator_tag, std::input_iterator_tag>;
+    using value_type = std::remove_cvref_t<reference>;
+    using difference_type = std::ptrdiff_t;
+
+    IndexedRangeIterator() = default;
+
+    IndexedRangeIterator(AdapterT* adapter, size_t i)
+    : m_adapter(adapter)
+    , m_i(i)
     {
-        this->advance_by(n);
     }
 
-    value_type operator*() { return this->m_iter.next(); }
-};
+    reference operator*() const { return m_adapter->get_at(m_i); }
 
-template <typename T>
-class [[nodiscard]] StepBy final : public AdapterBase<T, StepBy<T>> {
-public:
-    MOVE_ONLY(StepBy);
+    reference operator[](difference_type n) const { return *(*this + n); }
 
-    ALL_FRIEND;
+    IndexedRangeIterator& operator++()
+    {
+        ++m_i;
+        return *this;
+    }
 
-    using value_type = typename T::value_type;
+    IndexedRangeIterator operator++(int) { return {m_adapter, m_i++}; }
 
-    StepBy(T&& t, size_t step)
-    : AdapterBase<T, StepBy<T>>(std::move(t))
-    , m_step(step)
+    IndexedRangeIterator& operator--()
     {
-        assert(step != 0);
+        --m_i;
+        return *this;
     }
 
-    value_type operator*() { return next(); }
+    IndexedRangeIterator operator--(int) { return {m_adapter, m_i--}; }
 
-private:
-    value_type next() /* override */
+    IndexedRangeIterator& operator+=(difference_type n)
     {
-        value_type item = this->m_iter.next();
-        for (size_t i = 1; (!this->empty()) && (i < get_step()); ++i) {
-            this->m_iter.next();
-        }
-        return item;
+        m_i += static_cast<size_t>(n);
+        return *this;
     }
 
-    value_type next_back() /* override */
+    IndexedRangeIterator& operator-=(difference_type n)
     {
-        initial_step_back();
-        value_type item = this->m_iter.next_back();
-        for (size_t i = 1; (!this->empty()) && (i < get_step()); ++i) {
-            this->m_iter.next_back();
-        }
-        return item;
+        m_i -= static_cast<size_t>(n);
+        return *this;
     }
 
-    size_t get_step() const { return m_step & (static_cast<size_t>(-1) >> 1); }
+    friend IndexedRangeIterator operator+(IndexedRangeIterator it, difference_type n) { return it += n; }
+
+    friend IndexedRangeIterator operator+(difference_type n, IndexedRangeIterator it) { return it += n; }
 
-    bool get_flag() const { return m_step & ~(static_cast<size_t>(-1) >> 1); }
+    friend IndexedRangeIterator operator-(IndexedRangeIterator it, difference_type n) { return it -= n; }
 
-    void initial_step_back()
+    friend difference_type operator-(IndexedRangeIterator const& lhs, IndexedRangeIterator const& rhs)
     {
-        if (get_flag()) {
-            return;
-        }
+        return static_cast<difference_type>(lhs.m_i - rhs.m_i);
+    }
 
-        m_step |= ~(static_cast<size_t>(-1) >> 1);
-        size_t const initial_steps = (this->distance() - 1) % get_step();
-        for (size_t i = 0; (i < initial_steps) && (!this->empty()); ++i) {
-            this->m_iter.next_back();
-        }
+    friend bool operator==(IndexedRangeIterator const& lhs, IndexedRangeIterator const& rhs)
+    {
+        return lhs.m_i == rhs.m_i;
     }
 
-    size_t m_step;
+    friend auto operator<=>(IndexedRangeIterator const& lhs, IndexedRangeIterator const& rhs)
+    {
+        return lhs.m_i <=> rhs.m_i;
+    }
+
+private:
+    AdapterT* m_adapter = nullptr;
+    size_t m_i = 0;
 };
 
-template <typename T>
-class [[nodiscard]] Take final : public AdapterBase<T, Take<T>> {
+/// A std::ranges::view that owns an adapter. The elements of contiguous adapters are iterated by pointer, which makes
+/// a contiguous range; indexed, exact-sized adapters make common random access ranges of IndexedRangeIterators, and
+/// other adapters make input ranges of RangeIterators.
+template <typename AdapterT>
+class [[nodiscard]] RangeView final : public std::ranges::view_interface<RangeView<AdapterT>> {
 public:
-    MOVE_ONLY(Take);
-
-    ALL_FRIEND;
-
-    using value_type = typename T::value_type;
+    RangeView(RangeView const&) = delete;
+    RangeView& operator=(RangeView const&) = delete;
+    RangeView(RangeView&&) = default;
 
-    Take(T&& t, size_t n)
-    : AdapterBase<T, Take<T>>(std::move(t))
-    , m_n(n)
+    explicit RangeView(AdapterT&& adapter)
+    : m_adapter(std::move(adapter))
     {
-        if (m_n == 0) {
-            this->stop_iteration();
-        }
     }
 
-    value_type operator*() { return next(); }
-
-private:
-    value_type next() /* override */
+    // views must be movable, adapters holding lambdas are not assignable and are constructed anew instead
+    RangeView& operator=(RangeView&& other)
     {
-        value_type item = this->m_iter.next();
-        if (--m_n == 0) {
-            this->stop_iteration();
+        if (this != &other) {
+            m_adapter.reset();
+            if (other.m_adapter) {
+                m_adapter.emplace(std::move(*other.m_adapter));
+            }
         }
-        return item;
+        return *this;
     }
 
-    value_type next_back() /* override */
+    auto begin()
     {
-        value_type item = this->m_iter.next_back();
-        if (--m_n == 0) {
-            this->stop_iteration();
+        if constexpr (AdapterT::contiguous) {
+            return m_adapter->source().data();
+        }
+        else if constexpr (indexed) {
+            return IndexedRangeIterator<AdapterT>(&*m_adapter, 0);
+        }
+        else {
+            return RangeIterator<AdapterT>(&*m_adapter);
         }
-        return item;
     }
 
-    size_t m_n;
-};
-
-template <typename T, typename U>
-class [[nodiscard]] Zip final : public AdapterBase<T, Zip<T, U>> {
-public:
-    MOVE_ONLY(Zip);
-
-    ALL_FRIEND;
-
-    using value_type = std::pair<typename T::value_type, typename U::value_type>;
-
-    static_assert(std::is_base_of_v<Adapter, U>, "Adapter required");
-
-    explicit Zip(T&& t, U&& u)
-    : AdapterBase<T, Zip<T, U>>(std::move(t))
-    , m_zippedIter(std::move(u))
+    auto end()
     {
+        if constexpr (AdapterT::contiguous) {
+            auto const source = m_adapter->source();
+            return source.data() + source.size();
+        }
+        else if constexpr (indexed) {
+            return IndexedRangeIterator<AdapterT>(&*m_adapter, m_adapter->distance());
+        }
+        else {
+            return std::default_sentinel;
+        }
     }
 
-    value_type operator*() { return next(); }
+    size_t size() const requires AdapterT::exact_size { return m_adapter->size_hint().first; }
 
 private:
-    bool empty() const /* override */ { return this->m_iter.empty() || m_zippedIter.empty(); }
-
-    size_t distance() const /* override */ { return std::min(this->m_iter.distance(), m_zippedIter.distance()); }
-
-    value_type get() /* override */ { return {this->m_iter.get(), m_zippedIter.get()}; }
-
-    value_type get_back() /* override */ { return {this->m_iter.get_back(), m_zippedIter.get_back()}; }
-
-    value_type next() /* override */ { return {this->m_iter.next(), m_zippedIter.next()}; }
-
-    value_type next_back() /* override */ { return {this->m_iter.next_back(), m_zippedIter.next_back()}; }
+    static constexpr bool indexed = AdapterT::indexed && AdapterT::exact_size;
 
-    U m_zippedIter;
+    std::optional<AdapterT> m_adapter;
 };
+#endif
 
 template <typename IterT, typename T>
-auto mut_or_const_iter(T* t)
+constexpr auto mut_or_const_iter(T* t)
 {
     assert(t != nullptr);
     using PlainT = std::decay_t<T>;
@@ -812,17 +7294,183 @@ auto mut_or_const_iter(T* t)
 }
 } // namespace detail
 
+#if defined(__cpp_lib_coroutine)
+using detail::AsyncGenerator;
+using detail::Completion;
+using detail::Generator;
+#endif
+using detail::ProfileCounters;
+using detail::ProfileRecord;
+using detail::ThreadPool;
+
 template <typename T>
-auto iter(T const* t)
+constexpr auto iter(T const* t)
 {
     return detail::mut_or_const_iter<typename T::const_iterator>(t);
 }
 
 template <typename T>
-auto iter_mut(T* t)
+constexpr auto iter_mut(T* t)
 {
     return detail::mut_or_const_iter<typename T::iterator>(t);
 }
 
+/// yields rvalue references, so that the elements are moved out of the container and left in a moved-from state
+template <typename T>
+constexpr auto iter_move(T* t)
+{
+    return detail::mut_or_const_iter<std::move_iterator<typename T::iterator>>(t);
+}
+
+#if defined(__cpp_lib_ranges)
+/// the elements of a range or view, which is taken through std::views::all(): lvalue containers are borrowed and
+/// rvalue ones are moved into the adapter
+template <typename R>
+auto from_range(R&& r)
+{
+    static_assert(std::ranges::viewable_range<R>, "Viewable range required");
+    using Source = detail::FromRange<std::views::all_t<R>>;
+    return detail::Iterator<Source>(Source(std::views::all(std::forward<R>(r))));
+}
+#endif
+
+#if defined(__cpp_lib_coroutine)
+/// the elements that a coroutine returning Generator<T> produces with co_yield
+template <typename T>
+auto from_generator(Generator<T> generator)
+{
+    return detail::Iterator<detail::FromGenerator<T>>(detail::FromGenerator<T>(std::move(generator)));
+}
+
+/// the elements that a coroutine returning AsyncGenerator<T> produces with co_yield, resumed through the scheduler and
+/// buffered up to capacity elements ahead of the adapter
+template <typename T, typename SchedulerT>
+auto from_async(AsyncGenerator<T> generator, SchedulerT& scheduler, size_t capacity = 256)
+{
+    static_assert(detail::IsSchedulerV<SchedulerT>, "Scheduler required");
+    using Source = detail::FromAsync<T, SchedulerT>;
+    return detail::Iterator<Source>(Source(std::move(generator), scheduler, capacity));
+}
+#endif
+
+/// takes ownership of the container and yields rvalue references to its elements, the container is destroyed along
+/// with the last part of the adapter
+template <typename T>
+auto into_iter(T&& t)
+{
+    static_assert(!std::is_lvalue_reference_v<T>, "Pass the container by std::move(), or borrow it with iter_move()");
+    static_assert(detail::Iterable<T>, "Iterable required");
+    using Pair = detail::IterPair<T, std::move_iterator<typename T::iterator>, true>;
+    return detail::Iterator<Pair>(Pair(std::make_shared<T>(std::move(t))));
+}
+
+/// the adapters one after another, as a flat list of segments rather than nested chain() calls
+template <typename T, typename... Us>
+constexpr auto chain_all(T&& t, Us&&... us)
+{
+    static_assert(!std::is_lvalue_reference_v<T> && (!std::is_lvalue_reference_v<Us> && ...),
+                  "Adapters must be passed by value");
+    static_assert(std::is_base_of_v<detail::Adapter, T>, "Adapter required");
+    return detail::ChainAll<T, Us...>(std::move(t), std::move(us)...);
+}
+
+/// the elements of the adapters side by side, as flat std::tuples that end with the shortest adapter
+template <typename T, typename... Us>
+constexpr auto zip_all(T&& t, Us&&... us)
+{
+    static_assert(!std::is_lvalue_reference_v<T> && (!std::is_lvalue_reference_v<Us> && ...),
+                  "Adapters must be passed by value");
+    static_assert(std::is_base_of_v<detail::Adapter, T>, "Adapter required");
+    return detail::ZipAll<T, Us...>(std::move(t), std::move(us)...);
+}
+
+/// the elements of adapters that are each sorted by compare, in one sorted sequence
+template <typename T, typename CompareT = std::less<>>
+auto kmerge(std::vector<T> parts, CompareT&& compare = CompareT{})
+{
+    static_assert(std::is_base_of_v<detail::Adapter, T>, "Adapter required");
+    using Source = detail::KMerge<T, CompareT>;
+    return detail::Iterator<Source>(Source(std::move(parts), std::forward<CompareT>(compare)));
+}
+
+/// sources generating their elements without a backing container
+template <typename T, typename U>
+constexpr auto range(T first, U last)
+{
+    using ValueT = std::common_type_t<T, U>;
+    return detail::Iterator<detail::Range<ValueT>>(detail::Range<ValueT>(first, last, ValueT{1}));
+}
+
+/// the step may be negative for unsigned bounds as well, such as range(v.size(), 0, -1)
+template <typename T, typename U, typename StepT>
+constexpr auto range(T first, U last, StepT step)
+{
+    using ValueT = std::common_type_t<T, U, StepT>;
+    bool descending = false;
+    if constexpr (std::is_signed_v<StepT>) {
+        descending = (step < StepT{0});
+    }
+    using Source = detail::Range<ValueT>;
+    return detail::Iterator<Source>(Source(first, last, static_cast<ValueT>(step), descending));
+}
+
+template <typename T>
+constexpr auto repeat(T value)
+{
+    return detail::Iterator<detail::Repeat<T>>(detail::Repeat<T>(std::move(value)));
+}
+
+template <typename FnT>
+constexpr auto from_fn(FnT&& fn)
+{
+    return detail::Iterator<detail::FromFn<FnT>>(detail::FromFn<FnT>(std::forward<FnT>(fn)));
+}
+
+template <typename T, typename FnT>
+constexpr auto successors(T first, FnT&& fn)
+{
+    if constexpr (detail::IsOptionalV<T>) {
+        using Source = detail::Successors<typename T::value_type, FnT>;
+        return detail::Iterator<Source>(Source(std::move(first), std::forward<FnT>(fn)));
+    }
+    else {
+        using Source = detail::Successors<T, FnT>;
+        return detail::Iterator<Source>(Source(std::optional<T>(std::move(first)), std::forward<FnT>(fn)));
+    }
+}
+
+template <typename T>
+constexpr auto once(T value)
+{
+    return detail::Iterator<detail::Once<T>>(detail::Once<T>(std::move(value)));
+}
+
+/// I/O sources, the mapped ones throw std::system_error when the file cannot be mapped
+#if __has_include(<sys/mman.h>)
+inline auto mmap_lines(std::string const& path)
+{
+    return detail::Iterator<detail::MappedLines>(
+        detail::MappedLines(std::make_shared<detail::MappedFile const>(path)));
+}
+
+template <typename T>
+auto mmap_records(std::string const& path)
+{
+    using Pair = detail::IterPair<detail::MappedRecords<T>, T const*, true>;
+    return detail::Iterator<Pair>(Pair(std::make_shared<detail::MappedRecords<T> const>(path)));
+}
+#endif
+
+template <typename StreamT>
+auto read_lines(
+    StreamT& stream,
+    size_t chunk_size = 64 * 1024,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+{
+    return detail::Iterator<detail::ReadLines<StreamT>>(detail::ReadLines<StreamT>(stream, chunk_size, resource));
+}
+
 #undef MOVE_ONLY
 #undef ALL_FRIEND
+#undef ALWAYS_INLINE
+#undef TARGET_AVX2